@@ -0,0 +1,154 @@
+#include "CNFFeatures.h"
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace {
+
+    const double anyValue = std::numeric_limits<double>::infinity();
+
+    //formulas with this many variables are renumbered, smaller ones fit in the cache anyway
+    const unsigned renumberedVariableNum = 100000;
+
+    //satisfiability threshold of random k-SAT for k = 2 to 7, about 2^k ln 2 above
+    const double kSatThresholds[] = {1.0, 4.26, 9.93, 21.12, 43.37, 87.79};
+
+    struct PolicyRule {
+        double minBinaryClauseFraction;
+        double minLongClauseMeanLength;
+        double maxDominantLengthFraction;
+        double maxRelativeDensity;
+        double maxOccurrenceSkew;
+        CNFSolver::BranchingRule branchingRule;
+        bool triesLocalSearch;
+    };
+
+    //calibrated on the solve times of the three branching rules and ProbSAT with 2 million flips:
+    //pigeonhole-like formulas, binary exclusions and long clauses, are fastest with DLCS by 3 to 5 times,
+    //coloring-like ones, binary exclusions and short clauses, with MOMS,
+    //clauses of mixed lengths 3 to 6 with DLCS by 2 to 15 times,
+    //and uniform random k-SAT with lookahead by 2 to 20 times, ProbSAT solving most of it below the threshold
+    //in milliseconds where DPLL takes seconds, skewed occurrences make ProbSAT fail
+    const PolicyRule policyRules[] = {
+        {0.5, 5, anyValue, anyValue, anyValue, CNFSolver::DLCS, false},
+        {0.5, 0, anyValue, anyValue, anyValue, CNFSolver::MOMS, false},
+        {0, 0, 0.6, anyValue, anyValue, CNFSolver::DLCS, false},
+        {0, 0, anyValue, 0.95, 3, CNFSolver::Lookahead, true},
+        {0, 0, anyValue, anyValue, anyValue, CNFSolver::Lookahead, false}
+    };
+
+}
+
+CNFFeatures::CNFFeatures(const CNFFormula &formula)
+    : variableNum(formula.getVariableNum()),
+      clauseNum(formula.getClauseNum()),
+      lengthHistogram(),
+      dominantLength(0),
+      clauseVariableRatio(0),
+      binaryClauseFraction(0),
+      dominantLengthFraction(0),
+      longClauseMeanLength(0),
+      relativeDensity(0),
+      occurrenceSkew(0),
+      occurrenceDeviation(0) {
+    measure(formula);
+}
+
+CNFFeatures::CNFFeatures(const CNFInstance &instance)
+    : variableNum(instance.getVariableNum()),
+      clauseNum(instance.getClauseNum()),
+      lengthHistogram(),
+      dominantLength(0),
+      clauseVariableRatio(0),
+      binaryClauseFraction(0),
+      dominantLengthFraction(0),
+      longClauseMeanLength(0),
+      relativeDensity(0),
+      occurrenceSkew(0),
+      occurrenceDeviation(0) {
+    measure(instance);
+}
+
+//a CNFFormula or a CNFInstance, both give their clauses the same way
+template <typename Clauses>
+void CNFFeatures::measure(const Clauses &formula) {
+    std::vector<unsigned> occurrenceNums(variableNum + 1, 0);
+    std::vector<unsigned> lengthNums;
+    unsigned long long longLiteralNum = 0;
+    unsigned longClauseNum = 0;
+    for (unsigned i = 0; i < clauseNum; ++i) {
+        unsigned length = formula.getClauseLength(i);
+        const int *literals = formula.getClauseLiterals(i);
+        for (unsigned j = 0; j < length; ++j)
+            ++occurrenceNums[static_cast<unsigned>(std::abs(literals[j]))];
+        ++lengthHistogram[length < maxHistogramLength ? length : maxHistogramLength];
+        if (length >= lengthNums.size())
+            lengthNums.resize(length + 1, 0);
+        ++lengthNums[length];
+        if (length >= 3) {
+            longLiteralNum += length;
+            ++longClauseNum;
+        }
+    }
+    if (variableNum == 0 || clauseNum == 0)
+        return;
+
+    for (unsigned length = 1; length < lengthNums.size(); ++length) {
+        if (lengthNums[length] > lengthNums[dominantLength])
+            dominantLength = length;
+    }
+    clauseVariableRatio = static_cast<double>(clauseNum) / variableNum;
+    binaryClauseFraction = static_cast<double>(lengthHistogram[2]) / clauseNum;
+    dominantLengthFraction = static_cast<double>(lengthNums[dominantLength]) / clauseNum;
+    longClauseMeanLength = longClauseNum > 0 ? static_cast<double>(longLiteralNum) / longClauseNum : 0;
+    if (dominantLength >= 2) {
+        double threshold = dominantLength - 2 < sizeof(kSatThresholds) / sizeof(kSatThresholds[0])
+                ? kSatThresholds[dominantLength - 2] : std::ldexp(std::log(2.0), static_cast<int>(dominantLength));
+        relativeDensity = clauseVariableRatio / threshold;
+    }
+
+    unsigned long long occurrenceSum = 0;
+    unsigned maxOccurrenceNum = 0;
+    for (unsigned i = 1; i <= variableNum; ++i) {
+        occurrenceSum += occurrenceNums[i];
+        if (occurrenceNums[i] > maxOccurrenceNum)
+            maxOccurrenceNum = occurrenceNums[i];
+    }
+    double meanOccurrenceNum = static_cast<double>(occurrenceSum) / variableNum;
+    if (meanOccurrenceNum > 0) {
+        double squareSum = 0;
+        for (unsigned i = 1; i <= variableNum; ++i)
+            squareSum += (occurrenceNums[i] - meanOccurrenceNum) * (occurrenceNums[i] - meanOccurrenceNum);
+        occurrenceSkew = maxOccurrenceNum / meanOccurrenceNum;
+        occurrenceDeviation = std::sqrt(squareSum / variableNum) / meanOccurrenceNum;
+    }
+}
+
+CNFFeatures::Configuration CNFFeatures::getConfiguration() const {
+    Configuration configuration = {CNFSolver::Lookahead, false, variableNum >= renumberedVariableNum};
+    for (const PolicyRule &rule : policyRules) {
+        if (binaryClauseFraction >= rule.minBinaryClauseFraction
+                && longClauseMeanLength >= rule.minLongClauseMeanLength
+                && dominantLengthFraction <= rule.maxDominantLengthFraction
+                && relativeDensity <= rule.maxRelativeDensity
+                && occurrenceSkew <= rule.maxOccurrenceSkew) {
+            configuration.branchingRule = rule.branchingRule;
+            configuration.triesLocalSearch = rule.triesLocalSearch;
+            break;
+        }
+    }
+    return configuration;
+}
+
+void CNFFeatures::print(std::ostream &output) const {
+    output << "c features: " << variableNum << " variables, " << clauseNum << " clauses, ratio "
+           << clauseVariableRatio << std::endl;
+    output << "c clause lengths:";
+    for (unsigned length = 1; length <= maxHistogramLength; ++length)
+        output << ' ' << length << (length == maxHistogramLength ? "+:" : ":") << lengthHistogram[length];
+    output << std::endl;
+    output << "c binary fraction " << binaryClauseFraction << ", dominant length " << dominantLength
+           << " (" << dominantLengthFraction << "), density to threshold " << relativeDensity << std::endl;
+    output << "c occurrence skew " << occurrenceSkew << ", deviation " << occurrenceDeviation << std::endl;
+}
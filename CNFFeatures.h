@@ -0,0 +1,67 @@
+#ifndef CNFFEATURES_H
+#define CNFFEATURES_H
+
+#include "CNFFormula.h"
+#include "CNFInstance.h"
+#include "CNFSolver.h"
+#include <ostream>
+
+//features of a formula measured in one pass over its clauses, and the solver configuration they suggest
+//the configuration comes from a table of rules calibrated on random, mixed, coloring and pigeonhole formulas,
+//the first rule matching the features wins
+//XOR constraints and at-most-one groups are not measured, only the clauses
+class CNFFeatures {
+
+public:
+
+    static const unsigned maxHistogramLength = 8; //the last bucket counts the clauses of this length or longer
+
+    struct Configuration {
+        CNFSolver::BranchingRule branchingRule;
+        bool triesLocalSearch; //ProbSAT first, the formula is likely satisfiable
+        bool renumbersVariables; //large enough for the cache misses to matter
+    };
+
+    explicit CNFFeatures(const CNFFormula &);
+    explicit CNFFeatures(const CNFInstance &); //at-most-one groups turned into clauses are measured as well
+    Configuration getConfiguration() const;
+    void print(std::ostream &) const;
+    double getClauseVariableRatio() const;
+    double getBinaryClauseFraction() const;
+    double getOccurrenceSkew() const;
+    unsigned getClauseNumOfLength(unsigned) const;
+
+private:
+
+    unsigned variableNum;
+    unsigned clauseNum;
+    unsigned lengthHistogram[maxHistogramLength + 1]; //array size decided by maxHistogramLength, index 0 for empty clauses
+    unsigned dominantLength; //the most common clause length
+    double clauseVariableRatio;
+    double binaryClauseFraction;
+    double dominantLengthFraction;
+    double longClauseMeanLength; //mean length of the clauses with 3 or more literals
+    double relativeDensity; //clause/variable ratio over the random k-SAT threshold of the dominant length
+    double occurrenceSkew; //largest variable occurrence over the mean one
+    double occurrenceDeviation; //standard deviation of the variable occurrences over their mean
+
+    template <typename Clauses> void measure(const Clauses &);
+};
+
+inline double CNFFeatures::getClauseVariableRatio() const {
+    return clauseVariableRatio;
+}
+
+inline double CNFFeatures::getBinaryClauseFraction() const {
+    return binaryClauseFraction;
+}
+
+inline double CNFFeatures::getOccurrenceSkew() const {
+    return occurrenceSkew;
+}
+
+inline unsigned CNFFeatures::getClauseNumOfLength(unsigned length) const {
+    return lengthHistogram[length < maxHistogramLength ? length : maxHistogramLength];
+}
+
+#endif // CNFFEATURES_H
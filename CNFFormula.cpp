@@ -0,0 +1,216 @@
+#include "CNFFormula.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sstream>
+
+CNFFormula::CNFFormula(std::istream &input)
+    : variableNum(0),
+      clauseOffsets(1, 0),
+      xorOffsets(1, 0),
+      groupOffsets(1, 0) {
+    TRACE_SCOPE("CNFFormula::CNFFormula");
+    unsigned clauseNum = 0;
+    std::string line;
+    while (getline(input, line)) {
+        if (!line.empty() && line.front() == 'c')
+            addProjection(line.c_str());
+        if (!line.empty() && line.front() == 'p') {
+             std::stringstream ss(line);
+             std::string p, cnf;
+             ss >> p >> cnf >> variableNum >> clauseNum;
+             break;
+        }
+    }
+    literals.reserve(3 * static_cast<std::size_t>(clauseNum));
+    clauseOffsets.reserve(static_cast<std::size_t>(clauseNum) + 1);
+
+    //a constraint may span several lines, its type is given by the letter before its first literal
+    unsigned constraintNum = 0;
+    char constraintType = 0; //0 for a clause, x, a or e otherwise
+    unsigned clauseBegin = 0;
+    while (constraintNum < clauseNum && getline(input, line)) {
+        const char *position = line.c_str();
+        while (std::isspace(static_cast<unsigned char>(*position)))
+            ++position;
+        if (*position == 'c') {
+            addProjection(position);
+            continue;
+        }
+        if ((*position == 'x' || *position == 'a' || *position == 'e') && literals.size() == clauseBegin
+                && xorLiterals.size() == xorOffsets.back() && groupLiterals.size() == groupOffsets.back()) {
+            constraintType = *position;
+            ++position;
+        }
+        while (constraintNum < clauseNum) {
+            char *end;
+            int literal = static_cast<int>(std::strtol(position, &end, 10));
+            if (end == position)
+                break;
+            position = end;
+            if (literal == 0) {
+                finishConstraint(constraintType, clauseBegin);
+                ++constraintNum;
+                constraintType = 0;
+            }
+            else if (constraintType == 'x')
+                xorLiterals.push_back(literal);
+            else if (constraintType == 0)
+                addLiteral(literals, clauseBegin, literal);
+            else
+                addLiteral(groupLiterals, groupOffsets.back(), literal);
+        }
+    }
+    //the last constraint may miss its terminating zero
+    if (literals.size() > clauseBegin || xorLiterals.size() > xorOffsets.back() || groupLiterals.size() > groupOffsets.back())
+        finishConstraint(constraintType, clauseBegin);
+}
+
+void CNFFormula::addLiteral(std::vector<int> &constraintLiterals, unsigned begin, int literal) {
+    for (unsigned i = begin; i < constraintLiterals.size(); ++i) {
+        if (constraintLiterals[i] == literal)
+            return;
+    }
+    constraintLiterals.push_back(literal);
+}
+
+//an exactly-one group also gets the clause saying that at least one of its literals is true
+void CNFFormula::finishConstraint(char constraintType, unsigned &clauseBegin) {
+    if (constraintType == 'x')
+        xorOffsets.push_back(static_cast<unsigned>(xorLiterals.size()));
+    else if (constraintType != 0) {
+        if (constraintType == 'e')
+            literals.insert(literals.end(), groupLiterals.begin() + groupOffsets.back(), groupLiterals.end());
+        groupOffsets.push_back(static_cast<unsigned>(groupLiterals.size()));
+    }
+    if (constraintType == 0 || constraintType == 'e') {
+        clauseOffsets.push_back(static_cast<unsigned>(literals.size()));
+        clauseBegin = static_cast<unsigned>(literals.size());
+    }
+}
+
+void CNFFormula::addProjection(const char *position) {
+    ++position;
+    while (*position == ' ' || *position == '\t')
+        ++position;
+    if (std::strncmp(position, "ind", 3) != 0 || !std::isspace(static_cast<unsigned char>(position[3])))
+        return;
+    position += 3;
+    while (true) {
+        char *end;
+        long variable = std::strtol(position, &end, 10);
+        if (end == position || variable == 0)
+            return;
+        position = end;
+        if (variable > 0)
+            projection.push_back(static_cast<unsigned>(variable));
+    }
+}
+
+//a breadth-first search over the variable-clause graph from a variable of least occurrences,
+//the variables reached from one variable are numbered by increasing occurrences as in Cuthill-McKee,
+//and a clause is placed when the first of its variables is expanded, so the neighbours of a clause
+//get near numbers and the clauses of a variable are stored near each other
+void CNFFormula::renumber() {
+    TRACE_SCOPE("CNFFormula::renumber");
+    unsigned clauseNum = getClauseNum();
+    //clauses of every variable stored like the clauses
+    std::vector<unsigned> occurOffsets(variableNum + 2, 0);
+    for (int literal : literals)
+        ++occurOffsets[std::abs(literal) + 1];
+    for (unsigned i = 1; i <= variableNum + 1; ++i)
+        occurOffsets[i] += occurOffsets[i - 1];
+    std::vector<unsigned> occurClauses(literals.size());
+    std::vector<unsigned> positions(occurOffsets.begin(), occurOffsets.end() - 1);
+    for (unsigned i = 0; i < clauseNum; ++i) {
+        for (unsigned j = clauseOffsets[i]; j < clauseOffsets[i + 1]; ++j)
+            occurClauses[positions[std::abs(literals[j])]++] = i;
+    }
+    auto hasFewerOccurrences = [&occurOffsets](unsigned a, unsigned b) {
+        return occurOffsets[a + 1] - occurOffsets[a] < occurOffsets[b + 1] - occurOffsets[b];
+    };
+
+    std::vector<unsigned> startVariables(variableNum);
+    for (unsigned i = 0; i < variableNum; ++i)
+        startVariables[i] = i + 1;
+    std::stable_sort(startVariables.begin(), startVariables.end(), hasFewerOccurrences);
+
+    //the queue is the new order of the variables
+    std::vector<unsigned> order;
+    order.reserve(variableNum);
+    std::vector<bool> isReached(variableNum + 1, false);
+    std::vector<unsigned> clauseOrder;
+    clauseOrder.reserve(clauseNum);
+    std::vector<bool> isPlaced(clauseNum, false);
+    for (unsigned start : startVariables) {
+        if (isReached[start])
+            continue;
+        isReached[start] = true;
+        order.push_back(start);
+        for (std::size_t head = order.size() - 1; head < order.size(); ++head) {
+            unsigned variable = order[head];
+            std::size_t reachedBegin = order.size();
+            for (unsigned i = occurOffsets[variable]; i < occurOffsets[variable + 1]; ++i) {
+                unsigned clauseIndex = occurClauses[i];
+                if (isPlaced[clauseIndex])
+                    continue;
+                isPlaced[clauseIndex] = true;
+                clauseOrder.push_back(clauseIndex);
+                for (unsigned j = clauseOffsets[clauseIndex]; j < clauseOffsets[clauseIndex + 1]; ++j) {
+                    unsigned neighbour = static_cast<unsigned>(std::abs(literals[j]));
+                    if (!isReached[neighbour]) {
+                        isReached[neighbour] = true;
+                        order.push_back(neighbour);
+                    }
+                }
+            }
+            std::stable_sort(order.begin() + static_cast<std::ptrdiff_t>(reachedBegin), order.end(), hasFewerOccurrences);
+        }
+    }
+    //empty clauses have no variable to reach them
+    for (unsigned i = 0; i < clauseNum; ++i) {
+        if (!isPlaced[i])
+            clauseOrder.push_back(i);
+    }
+
+    //a formula renumbered again still maps back to the file
+    std::vector<unsigned> newVariables(variableNum + 1, 0);
+    std::vector<unsigned> previousVariables(originalVariables);
+    originalVariables.assign(variableNum + 1, 0);
+    for (unsigned i = 0; i < variableNum; ++i) {
+        newVariables[order[i]] = i + 1;
+        originalVariables[i + 1] = previousVariables.empty() ? order[i] : previousVariables[order[i]];
+    }
+    auto renumberLiteral = [&newVariables](int literal) {
+        int variable = static_cast<int>(newVariables[std::abs(literal)]);
+        return literal > 0 ? variable : -variable;
+    };
+    std::vector<int> renumberedLiterals;
+    renumberedLiterals.reserve(literals.size());
+    std::vector<unsigned> renumberedOffsets(1, 0);
+    renumberedOffsets.reserve(clauseOffsets.size());
+    for (unsigned clauseIndex : clauseOrder) {
+        for (unsigned j = clauseOffsets[clauseIndex]; j < clauseOffsets[clauseIndex + 1]; ++j)
+            renumberedLiterals.push_back(renumberLiteral(literals[j]));
+        renumberedOffsets.push_back(static_cast<unsigned>(renumberedLiterals.size()));
+    }
+    literals.swap(renumberedLiterals);
+    clauseOffsets.swap(renumberedOffsets);
+    std::transform(xorLiterals.begin(), xorLiterals.end(), xorLiterals.begin(), renumberLiteral);
+    std::transform(groupLiterals.begin(), groupLiterals.end(), groupLiterals.begin(), renumberLiteral);
+}
+
+double CNFFormula::getClauseSpan() const {
+    unsigned long long spanSum = 0;
+    for (unsigned i = 0; i < getClauseNum(); ++i) {
+        if (getClauseLength(i) == 0)
+            continue;
+        auto bounds = std::minmax_element(literals.begin() + clauseOffsets[i], literals.begin() + clauseOffsets[i + 1],
+                                          [](int a, int b) { return std::abs(a) < std::abs(b); });
+        spanSum += static_cast<unsigned>(std::abs(*bounds.second) - std::abs(*bounds.first));
+    }
+    return getClauseNum() > 0 ? static_cast<double>(spanSum) / getClauseNum() : 0;
+}
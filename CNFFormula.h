@@ -0,0 +1,106 @@
+#ifndef CNFFORMULA_H
+#define CNFFORMULA_H
+
+#include <iostream>
+#include <vector>
+
+//a DIMACS CNF formula as parsed, shared by the DPLL solver and the local search engine
+//the literals of all clauses are stored back to back, duplicate literals in a clause are removed
+//lines starting with x are XOR constraints as in CryptoMiniSat, "x1 -2 3 0" means x1 ^ !x2 ^ x3 = 1
+//lines starting with a are at-most-one groups, "a1 2 3 0" means at most one of x1, x2 and x3 is true,
+//and lines starting with e are exactly-one groups, stored as an at-most-one group and a clause
+//all of them are stored apart from the clauses and counted by the clause number of the header
+//comment lines "c ind 1 2 3 0" give the variables that models are projected onto when enumerated
+//renumber stores related variables and clauses together, the projection keeps the numbers of the file
+class CNFFormula {
+
+public:
+
+    explicit CNFFormula(std::istream &);
+
+    unsigned getVariableNum() const;
+    unsigned getClauseNum() const;
+    unsigned getClauseLength(unsigned) const;
+    const int *getClauseLiterals(unsigned) const; //clause index is from 0 to getClauseNum() - 1
+    unsigned getLiteralNum() const;
+    unsigned getXorNum() const;
+    unsigned getXorLength(unsigned) const;
+    const int *getXorLiterals(unsigned) const; //XOR index is from 0 to getXorNum() - 1
+    unsigned getGroupNum() const;
+    unsigned getGroupLength(unsigned) const;
+    const int *getGroupLiterals(unsigned) const; //at-most-one group index is from 0 to getGroupNum() - 1
+    const std::vector<unsigned> &getProjection() const; //empty when there is no c ind line
+    void renumber(); //Cuthill-McKee order of the variables, clauses in the order their first variable is reached
+    const std::vector<unsigned> &getOriginalVariables() const; //variable of the file for every variable, empty unless renumbered
+    double getClauseSpan() const; //average distance of the smallest and the largest variable of a clause
+
+private:
+
+    unsigned variableNum;
+    std::vector<int> literals;
+    std::vector<unsigned> clauseOffsets; //clause i is literals[clauseOffsets[i]] to literals[clauseOffsets[i + 1] - 1]
+    std::vector<int> xorLiterals;
+    std::vector<unsigned> xorOffsets; //stored like the clauses
+    std::vector<int> groupLiterals;
+    std::vector<unsigned> groupOffsets; //stored like the clauses, duplicate literals are removed
+    std::vector<unsigned> projection;
+    std::vector<unsigned> originalVariables;
+
+    static void addLiteral(std::vector<int> &, unsigned, int);
+    void finishConstraint(char, unsigned &);
+    void addProjection(const char *);
+};
+
+inline unsigned CNFFormula::getVariableNum() const {
+    return variableNum;
+}
+
+inline unsigned CNFFormula::getClauseNum() const {
+    return static_cast<unsigned>(clauseOffsets.size()) - 1;
+}
+
+inline unsigned CNFFormula::getClauseLength(unsigned clauseIndex) const {
+    return clauseOffsets[clauseIndex + 1] - clauseOffsets[clauseIndex];
+}
+
+inline const int *CNFFormula::getClauseLiterals(unsigned clauseIndex) const {
+    return literals.data() + clauseOffsets[clauseIndex];
+}
+
+inline unsigned CNFFormula::getLiteralNum() const {
+    return static_cast<unsigned>(literals.size());
+}
+
+inline unsigned CNFFormula::getXorNum() const {
+    return static_cast<unsigned>(xorOffsets.size()) - 1;
+}
+
+inline unsigned CNFFormula::getXorLength(unsigned xorIndex) const {
+    return xorOffsets[xorIndex + 1] - xorOffsets[xorIndex];
+}
+
+inline const int *CNFFormula::getXorLiterals(unsigned xorIndex) const {
+    return xorLiterals.data() + xorOffsets[xorIndex];
+}
+
+inline unsigned CNFFormula::getGroupNum() const {
+    return static_cast<unsigned>(groupOffsets.size()) - 1;
+}
+
+inline unsigned CNFFormula::getGroupLength(unsigned groupIndex) const {
+    return groupOffsets[groupIndex + 1] - groupOffsets[groupIndex];
+}
+
+inline const int *CNFFormula::getGroupLiterals(unsigned groupIndex) const {
+    return groupLiterals.data() + groupOffsets[groupIndex];
+}
+
+inline const std::vector<unsigned> &CNFFormula::getProjection() const {
+    return projection;
+}
+
+inline const std::vector<unsigned> &CNFFormula::getOriginalVariables() const {
+    return originalVariables;
+}
+
+#endif // CNFFORMULA_H
@@ -0,0 +1,213 @@
+#include "CNFInstance.h"
+#include "Trace.h"
+#include "XorMatrix.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+    //FNV-1a, the same hash as the snapshots of CNFSolver have always used
+    unsigned long long addHash(unsigned long long hash, unsigned long long value) {
+        for (unsigned i = 0; i < 8; ++i) {
+            hash ^= (value >> (8 * i)) & 255;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    unsigned long long hashFormula(const CNFFormula &formula) {
+        unsigned long long hash = addHash(14695981039346656037ULL, formula.getVariableNum());
+        for (unsigned i = 0; i < formula.getClauseNum(); ++i) {
+            hash = addHash(hash, formula.getClauseLength(i));
+            for (unsigned j = 0; j < formula.getClauseLength(i); ++j)
+                hash = addHash(hash, static_cast<unsigned long long>(formula.getClauseLiterals(i)[j]));
+        }
+        for (unsigned i = 0; i < formula.getXorNum(); ++i) {
+            hash = addHash(hash, formula.getXorLength(i));
+            for (unsigned j = 0; j < formula.getXorLength(i); ++j)
+                hash = addHash(hash, static_cast<unsigned long long>(formula.getXorLiterals(i)[j]));
+        }
+        for (unsigned i = 0; i < formula.getGroupNum(); ++i) {
+            hash = addHash(hash, formula.getGroupLength(i));
+            for (unsigned j = 0; j < formula.getGroupLength(i); ++j)
+                hash = addHash(hash, static_cast<unsigned long long>(formula.getGroupLiterals(i)[j]));
+        }
+        return hash;
+    }
+
+}
+
+CNFInstance::CNFInstance()
+    : variableNum(0),
+      clauseOffsets(1, 0),
+      maxClauseLength(0),
+      binaryClauseNum(0),
+      xorMatrix(nullptr),
+      hasOnlyClauses(false),
+      formulaHash(0) {}
+
+CNFInstance::CNFInstance(const CNFFormula &formula, bool detectsXors)
+    : CNFInstance() {
+    TRACE_SCOPE("CNFInstance::CNFInstance");
+    variableNum = formula.getVariableNum();
+
+    xorMatrix = detectsXors ? new XorMatrix(formula) : new XorMatrix(formula, 0);
+    if (xorMatrix->isEmpty()) {
+        delete xorMatrix;
+        xorMatrix = nullptr;
+    }
+
+    clauseLiterals.reserve(formula.getLiteralNum());
+    clauseOffsets.reserve(static_cast<std::size_t>(formula.getClauseNum()) + 1);
+    for (unsigned i = 0; i < formula.getClauseNum(); ++i)
+        addClause(formula.getClauseLiterals(i), formula.getClauseLength(i));
+
+    //groups of positive literals are propagated natively, a model then makes their free variables false
+    //the other groups, and all the groups when that could break XOR constraints, become pairwise clauses
+    std::vector<std::vector<unsigned>> groups;
+    for (unsigned i = 0; i < formula.getGroupNum(); ++i) {
+        const int *literals = formula.getGroupLiterals(i);
+        unsigned length = formula.getGroupLength(i);
+        if (xorMatrix == nullptr && std::all_of(literals, literals + length, [](int literal) { return literal > 0; }))
+            groups.emplace_back(literals, literals + length);
+        else {
+            for (unsigned j = 0; j < length; ++j) {
+                for (unsigned k = j + 1; k < length; ++k) {
+                    int pair[2] = {-literals[j], -literals[k]};
+                    addClause(pair, 2);
+                }
+            }
+        }
+    }
+    buildImplications();
+    buildOccurrences();
+    buildGroups(groups);
+
+    hasOnlyClauses = xorMatrix == nullptr && formula.getGroupNum() == 0;
+    formulaHash = hashFormula(formula);
+    if (!formula.getOriginalVariables().empty()) {
+        originalVariables = formula.getOriginalVariables();
+        renumberedVariables.assign(variableNum + 1, 0);
+        for (unsigned i = 1; i <= variableNum; ++i)
+            renumberedVariables[originalVariables[i]] = i;
+    }
+}
+
+CNFInstance::~CNFInstance() {
+    delete xorMatrix;
+}
+
+//every constraint is that exactly one of 9 variables is true,
+//which is a clause for at least one and a group for at most one
+//the givens are left to the solvers, so all of them share this instance
+std::shared_ptr<const CNFInstance> CNFInstance::getSudokuInstance() {
+    static std::shared_ptr<const CNFInstance> sudokuInstance([] {
+        CNFInstance *instance = new CNFInstance;
+        instance->variableNum = 729;
+        auto sudokuVariable = [](unsigned row, unsigned column, unsigned digit) {
+            return 81 * (row - 1) + 9 * (column - 1) + digit;
+        };
+        std::vector<std::vector<unsigned>> groups(324, std::vector<unsigned>(9));
+        unsigned groupIndex = 0;
+        for (unsigned i = 1; i <= 9; ++i) {
+            for (unsigned j = 1; j <= 9; ++j) {
+                for (unsigned k = 1; k <= 9; ++k) {
+                    //There is exactly one number in entry (i, j)
+                    groups[groupIndex][k - 1] = sudokuVariable(i, j, k);
+                    //Number i appears exactly once in row j
+                    groups[groupIndex + 81][k - 1] = sudokuVariable(k, j, i);
+                    //Number i appears exactly once in column j
+                    groups[groupIndex + 162][k - 1] = sudokuVariable(j, k, i);
+                    //Number i appears exactly once in 3x3 sub-grid j
+                    groups[groupIndex + 243][k - 1] = sudokuVariable((j - 1) / 3 * 3 + (k - 1) / 3 + 1, (j - 1) % 3 * 3 + (k - 1) % 3 + 1, i);
+                }
+                ++groupIndex;
+            }
+        }
+        for (const std::vector<unsigned> &group : groups) {
+            std::vector<int> literals(group.begin(), group.end());
+            instance->addClause(literals.data(), static_cast<unsigned>(literals.size()));
+        }
+        instance->buildImplications();
+        instance->buildOccurrences();
+        instance->buildGroups(groups);
+        return instance;
+    }());
+    return sudokuInstance;
+}
+
+void CNFInstance::addClause(const int *literals, unsigned length) {
+    if (length == 2 && std::abs(literals[0]) != std::abs(literals[1])) {
+        binaryClauses.emplace_back(literals[0], literals[1]);
+        return;
+    }
+    clauseLiterals.insert(clauseLiterals.end(), literals, literals + length);
+    clauseOffsets.push_back(static_cast<unsigned>(clauseLiterals.size()));
+    maxClauseLength = std::max(maxClauseLength, length);
+    if (length == 1 && std::find(unitLiterals.begin(), unitLiterals.end(), literals[0]) == unitLiterals.end())
+        unitLiterals.push_back(literals[0]);
+}
+
+//the binary clauses go behind the others, every one of them once for each of its literals
+void CNFInstance::buildImplications() {
+    implicationOffsets.assign(2 * static_cast<std::size_t>(variableNum) + 3, 0);
+    for (const std::pair<int, int> &clause : binaryClauses) {
+        ++implicationOffsets[2 * static_cast<unsigned>(std::abs(clause.first)) + (clause.first < 0) + 1];
+        ++implicationOffsets[2 * static_cast<unsigned>(std::abs(clause.second)) + (clause.second < 0) + 1];
+    }
+    for (std::size_t i = 1; i < implicationOffsets.size(); ++i)
+        implicationOffsets[i] += implicationOffsets[i - 1];
+    implicationLiterals.resize(2 * binaryClauses.size());
+    std::vector<unsigned> positions(implicationOffsets.begin(), implicationOffsets.end() - 1);
+    for (const std::pair<int, int> &clause : binaryClauses) {
+        implicationLiterals[positions[2 * static_cast<unsigned>(std::abs(clause.first)) + (clause.first < 0)]++] = clause.second;
+        implicationLiterals[positions[2 * static_cast<unsigned>(std::abs(clause.second)) + (clause.second < 0)]++] = clause.first;
+        int literals[2] = {clause.first, clause.second};
+        clauseLiterals.insert(clauseLiterals.end(), literals, literals + 2);
+        clauseOffsets.push_back(static_cast<unsigned>(clauseLiterals.size()));
+        maxClauseLength = std::max(maxClauseLength, 2u);
+    }
+    binaryClauseNum = static_cast<unsigned>(binaryClauses.size());
+    std::vector<std::pair<int, int>>().swap(binaryClauses);
+}
+
+//counted first, then filled, so the occurrences of a literal are in clause order
+void CNFInstance::buildOccurrences() {
+    unsigned occurClauseNum = getClauseNum() - binaryClauseNum;
+    occurOffsets.assign(2 * static_cast<std::size_t>(variableNum) + 3, 0);
+    for (unsigned i = 0; i < clauseOffsets[occurClauseNum]; ++i)
+        ++occurOffsets[2 * static_cast<unsigned>(std::abs(clauseLiterals[i])) + (clauseLiterals[i] < 0) + 1];
+    for (std::size_t i = 1; i < occurOffsets.size(); ++i)
+        occurOffsets[i] += occurOffsets[i - 1];
+    occurClauses.resize(clauseOffsets[occurClauseNum]);
+    std::vector<unsigned> positions(occurOffsets.begin(), occurOffsets.end() - 1);
+    for (unsigned i = 0; i < occurClauseNum; ++i) {
+        for (unsigned j = clauseOffsets[i]; j < clauseOffsets[i + 1]; ++j)
+            occurClauses[positions[2 * static_cast<unsigned>(std::abs(clauseLiterals[j])) + (clauseLiterals[j] < 0)]++] = i;
+    }
+}
+
+//groups are stored back to back like the occurrence lists, with the groups of each variable beside them
+void CNFInstance::buildGroups(const std::vector<std::vector<unsigned>> &groups) {
+    if (groups.empty())
+        return;
+    unsigned groupNum = static_cast<unsigned>(groups.size());
+    groupOffsets.assign(groupNum + 1, 0);
+    for (unsigned i = 0; i < groupNum; ++i)
+        groupOffsets[i + 1] = groupOffsets[i] + static_cast<unsigned>(groups[i].size());
+    groupVariables.resize(groupOffsets[groupNum]);
+    variableGroupOffsets.assign(variableNum + 2, 0);
+    for (unsigned i = 0; i < groupNum; ++i) {
+        std::copy(groups[i].begin(), groups[i].end(), groupVariables.begin() + groupOffsets[i]);
+        for (unsigned variable : groups[i])
+            ++variableGroupOffsets[variable + 1];
+    }
+    for (unsigned i = 1; i <= variableNum + 1; ++i)
+        variableGroupOffsets[i] += variableGroupOffsets[i - 1];
+    variableGroups.resize(groupOffsets[groupNum]);
+    std::vector<unsigned> positions(variableGroupOffsets.begin(), variableGroupOffsets.end() - 1);
+    for (unsigned i = 0; i < groupNum; ++i) {
+        for (unsigned variable : groups[i])
+            variableGroups[positions[variable]++] = i;
+    }
+}
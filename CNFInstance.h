@@ -0,0 +1,179 @@
+#ifndef CNFINSTANCE_H
+#define CNFINSTANCE_H
+
+#include "CNFFormula.h"
+#include <memory>
+#include <utility>
+#include <vector>
+
+class XorMatrix;
+
+//the read-only part of a formula as the DPLL solver needs it, built once and shared by any number of solvers
+//clauses, occurrence lists and at-most-one groups are stored back to back and never written after the
+//constructor, so solvers on different threads read them without locking and only allocate their search state
+//at-most-one groups with negative literals become pairwise clauses behind the clauses of the formula
+//binary clauses are moved behind all the others and kept as implications instead of occurrences
+class CNFInstance {
+
+public:
+
+    explicit CNFInstance(const CNFFormula &, bool detectsXors = true); //without detection only x lines become XOR constraints
+    ~CNFInstance();
+    static std::shared_ptr<const CNFInstance> getSudokuInstance(); //variable 81 * (row - 1) + 9 * (column - 1) + digit
+
+    unsigned getVariableNum() const;
+    unsigned getClauseNum() const;
+    unsigned getBinaryClauseNum() const; //the last ones, clauses of two different variables
+    unsigned getClauseLength(unsigned) const;
+    const int *getClauseLiterals(unsigned) const; //clause index is from 0 to getClauseNum() - 1
+    unsigned getMaxClauseLength() const;
+    const std::vector<int> &getUnitLiterals() const; //literals of the unit clauses, each once
+
+    //clauses of a literal are occurClauses[occurOffsets[i]] to occurClauses[occurOffsets[i + 1] - 1],
+    //i being 2 * variable + (literal < 0), binary clauses excluded
+    const unsigned *getOccurOffsets() const;
+    const unsigned *getOccurClauses() const;
+
+    //the other literals of the binary clauses of a literal, implied once it is false, stored like the occurrences
+    //both nullptr without binary clauses
+    const unsigned *getImplicationOffsets() const;
+    const int *getImplicationLiterals() const;
+
+    //groups of variables propagated natively, stored like the occurrences
+    unsigned getGroupNum() const;
+    const unsigned *getGroupOffsets() const;
+    const unsigned *getGroupVariables() const;
+    const unsigned *getVariableGroupOffsets() const; //groups of variable i start at getVariableGroupOffsets()[i]
+    const unsigned *getVariableGroups() const;
+
+    const XorMatrix *getXorMatrix() const; //reduced XOR constraints to be copied by every solver, nullptr for none
+    bool isProofSupported() const; //clauses only, so a DRAT checker can read the same formula
+    const unsigned *getOriginalVariables() const; //variable of the file for every variable, nullptr unless renumbered
+    const unsigned *getRenumberedVariables() const; //the inverse of the above
+    unsigned long long getFormulaHash() const;
+
+    //disable all the unused functions
+    CNFInstance(const CNFInstance &) = delete;
+    CNFInstance(CNFInstance &&) = delete;
+    CNFInstance &operator=(const CNFInstance &) = delete;
+    CNFInstance &operator=(CNFInstance &&) = delete;
+
+private:
+
+    unsigned variableNum;
+    std::vector<int> clauseLiterals;
+    std::vector<unsigned> clauseOffsets; //clause i is clauseLiterals[clauseOffsets[i]] to clauseLiterals[clauseOffsets[i + 1] - 1]
+    unsigned maxClauseLength;
+    std::vector<int> unitLiterals;
+
+    std::vector<unsigned> occurOffsets; //size 2 * variableNum + 3
+    std::vector<unsigned> occurClauses;
+
+    std::vector<std::pair<int, int>> binaryClauses; //moved into the clauses by buildImplications
+    unsigned binaryClauseNum;
+    std::vector<unsigned> implicationOffsets; //size 2 * variableNum + 3
+    std::vector<int> implicationLiterals;
+
+    std::vector<unsigned> groupOffsets;
+    std::vector<unsigned> groupVariables;
+    std::vector<unsigned> variableGroupOffsets; //size variableNum + 2
+    std::vector<unsigned> variableGroups;
+
+    XorMatrix *xorMatrix;
+    bool hasOnlyClauses;
+    std::vector<unsigned> originalVariables;
+    std::vector<unsigned> renumberedVariables;
+    unsigned long long formulaHash;
+
+    CNFInstance();
+    void addClause(const int *, unsigned);
+    void buildImplications();
+    void buildOccurrences();
+    void buildGroups(const std::vector<std::vector<unsigned>> &);
+};
+
+inline unsigned CNFInstance::getVariableNum() const {
+    return variableNum;
+}
+
+inline unsigned CNFInstance::getClauseNum() const {
+    return static_cast<unsigned>(clauseOffsets.size()) - 1;
+}
+
+inline unsigned CNFInstance::getBinaryClauseNum() const {
+    return binaryClauseNum;
+}
+
+inline unsigned CNFInstance::getClauseLength(unsigned clauseIndex) const {
+    return clauseOffsets[clauseIndex + 1] - clauseOffsets[clauseIndex];
+}
+
+inline const int *CNFInstance::getClauseLiterals(unsigned clauseIndex) const {
+    return clauseLiterals.data() + clauseOffsets[clauseIndex];
+}
+
+inline unsigned CNFInstance::getMaxClauseLength() const {
+    return maxClauseLength;
+}
+
+inline const std::vector<int> &CNFInstance::getUnitLiterals() const {
+    return unitLiterals;
+}
+
+inline const unsigned *CNFInstance::getOccurOffsets() const {
+    return occurOffsets.data();
+}
+
+inline const unsigned *CNFInstance::getOccurClauses() const {
+    return occurClauses.data();
+}
+
+inline const unsigned *CNFInstance::getImplicationOffsets() const {
+    return binaryClauseNum != 0 ? implicationOffsets.data() : nullptr;
+}
+
+inline const int *CNFInstance::getImplicationLiterals() const {
+    return binaryClauseNum != 0 ? implicationLiterals.data() : nullptr;
+}
+
+inline unsigned CNFInstance::getGroupNum() const {
+    return groupOffsets.empty() ? 0 : static_cast<unsigned>(groupOffsets.size()) - 1;
+}
+
+inline const unsigned *CNFInstance::getGroupOffsets() const {
+    return groupOffsets.data();
+}
+
+inline const unsigned *CNFInstance::getGroupVariables() const {
+    return groupVariables.data();
+}
+
+inline const unsigned *CNFInstance::getVariableGroupOffsets() const {
+    return variableGroupOffsets.data();
+}
+
+inline const unsigned *CNFInstance::getVariableGroups() const {
+    return variableGroups.data();
+}
+
+inline const XorMatrix *CNFInstance::getXorMatrix() const {
+    return xorMatrix;
+}
+
+inline bool CNFInstance::isProofSupported() const {
+    return hasOnlyClauses;
+}
+
+inline const unsigned *CNFInstance::getOriginalVariables() const {
+    return originalVariables.empty() ? nullptr : originalVariables.data();
+}
+
+inline const unsigned *CNFInstance::getRenumberedVariables() const {
+    return renumberedVariables.empty() ? nullptr : renumberedVariables.data();
+}
+
+inline unsigned long long CNFInstance::getFormulaHash() const {
+    return formulaHash;
+}
+
+#endif // CNFINSTANCE_H
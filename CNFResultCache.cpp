@@ -0,0 +1,386 @@
+#include "CNFResultCache.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+    const char entryMagic[8] = {'C', 'N', 'F', 'R', 'E', 'S', 'L', 'T'};
+    //version of the solvers, of the result text and of the entry format, which every entry name ends with
+    //bump it with any change that could give another result or text for the same file and options
+    const unsigned long long resultVersion = 2;
+    const char indexFileName[] = "index";
+    const std::size_t hashBufferSize = 1 << 20; //a multiple of 8, so only the last read leaves a partial word
+
+    //variable-length numbers as in the checkpoints, 7 bits per byte with the high bit set on all but the last
+    void putNumber(std::vector<char> &buffer, unsigned long long value) {
+        while (value > 127) {
+            buffer.push_back(static_cast<char>(128 | (value & 127)));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void putString(std::vector<char> &buffer, const std::string &value) {
+        putNumber(buffer, value.size());
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    bool getNumber(const char *&position, const char *end, unsigned long long &value) {
+        value = 0;
+        for (unsigned shift = 0; position != end && shift < 64; shift += 7) {
+            unsigned char byte = static_cast<unsigned char>(*position++);
+            value |= static_cast<unsigned long long>(byte & 127) << shift;
+            if (byte < 128)
+                return true;
+        }
+        return false;
+    }
+
+    bool getString(const char *&position, const char *end, std::string &value) {
+        unsigned long long length;
+        if (!getNumber(position, end, length) || length > static_cast<unsigned long long>(end - position))
+            return false;
+        value.assign(position, static_cast<std::size_t>(length));
+        position += length;
+        return true;
+    }
+
+    //a word at a time in two lanes with different multipliers, several times faster than reading the file
+    inline void addWord(unsigned long long *hashes, unsigned long long word) {
+        hashes[0] = (hashes[0] ^ word) * 0x9E3779B97F4A7C15ULL;
+        hashes[0] ^= hashes[0] >> 32;
+        hashes[1] = (hashes[1] + (word << 29 | word >> 35)) * 0xC2B2AE3D27D4EB4FULL;
+        hashes[1] ^= hashes[1] >> 29;
+    }
+
+    //the finalizer of SplitMix64, so that every bit of a lane affects every bit of the hash
+    inline unsigned long long mix(unsigned long long value) {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    //FNV-1a
+    unsigned long long hashString(const std::string &value) {
+        unsigned long long hash = 14695981039346656037ULL;
+        for (char character : value) {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::string getVersionSuffix() {
+        return "-v" + std::to_string(resultVersion);
+    }
+
+    //written to a temporary file and renamed, as the checkpoints are
+    bool writeFile(const std::string &fileName, const std::string &temporaryFileName, const std::vector<char> &buffer) {
+        {
+            std::ofstream file(temporaryFileName, std::ios::binary | std::ios::trunc);
+            if (!file.write(buffer.data(), static_cast<std::streamsize>(buffer.size())) || !file.flush()) {
+                file.close();
+                std::remove(temporaryFileName.c_str());
+                return false;
+            }
+        }
+        //rename does not replace an existing file everywhere
+        if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0) {
+            std::remove(fileName.c_str());
+            if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0) {
+                std::remove(temporaryFileName.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
+
+std::string CNFResultCache::Key::getName() const {
+    std::ostringstream name;
+    name << std::hex << std::setfill('0') << std::setw(16) << hashes[0] << std::setw(16) << hashes[1]
+         << '-' << std::setw(16) << hashString(optionTag) << getVersionSuffix();
+    return name.str();
+}
+
+CNFResultCache::CNFResultCache(unsigned long long capacity)
+    : capacity(capacity),
+      size(0),
+      isIndexChanged(false),
+      temporaryNum(0),
+      hitNum(0),
+      missNum(0) {}
+
+CNFResultCache::~CNFResultCache() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isIndexChanged)
+        saveIndex();
+}
+
+CNFResultCache &CNFResultCache::getInstance() {
+    static CNFResultCache cache;
+    return cache;
+}
+
+bool CNFResultCache::makeKey(const std::string &fileName, const std::string &optionTag, Key &key) {
+    TRACE_SCOPE("CNFResultCache::makeKey");
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file)
+        return false;
+    key.hashes[0] = 0x243F6A8885A308D3ULL;
+    key.hashes[1] = 0x13198A2E03707344ULL;
+    key.fileSize = 0;
+    key.optionTag = optionTag;
+    std::vector<char> buffer(hashBufferSize);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::size_t readSize = static_cast<std::size_t>(file.gcount());
+        key.fileSize += readSize;
+        std::size_t wordEnd = readSize / 8 * 8;
+        for (std::size_t i = 0; i < wordEnd; i += 8) {
+            unsigned long long word;
+            std::memcpy(&word, buffer.data() + i, 8);
+            addWord(key.hashes, word);
+        }
+        if (wordEnd < readSize) {
+            unsigned long long word = 0;
+            std::memcpy(&word, buffer.data() + wordEnd, readSize - wordEnd);
+            addWord(key.hashes, word);
+        }
+    }
+    if (file.bad())
+        return false;
+    key.hashes[0] = mix(key.hashes[0] ^ key.fileSize);
+    key.hashes[1] = mix(key.hashes[1] + key.fileSize);
+    return true;
+}
+
+void CNFResultCache::setDirectory(const std::string &directory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isIndexChanged)
+        saveIndex();
+    this->directory = directory;
+    if (!this->directory.empty() && this->directory.back() != '/' && this->directory.back() != '\\')
+        this->directory += '/';
+    entries.clear();
+    positions.clear();
+    size = 0;
+    isIndexChanged = false;
+    if (!this->directory.empty())
+        loadIndex();
+}
+
+bool CNFResultCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !directory.empty();
+}
+
+//the entry is read without the lock, another job may evict it meanwhile, which is then a miss
+bool CNFResultCache::find(const Key &key, Entry &entry) {
+    TRACE_SCOPE("CNFResultCache::find");
+    std::string name = key.getName();
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (directory.empty())
+            return false;
+        path = getPath(name);
+    }
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> data;
+    if (file)
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    //the whole key is in the entry, a file of a colliding name or of another version is not used
+    bool isFound = data.size() >= sizeof(entryMagic) && std::equal(entryMagic, entryMagic + sizeof(entryMagic), data.begin());
+    const char *position = isFound ? data.data() + sizeof(entryMagic) : nullptr;
+    const char *end = isFound ? data.data() + data.size() : nullptr;
+    unsigned long long header[4];
+    std::string optionTag;
+    unsigned long long isSatisfied;
+    unsigned long long maxDecisionDepth;
+    CNFSolver::Statistics &statistics = entry.statistics;
+    isFound = isFound
+            && getNumber(position, end, header[0]) && header[0] == resultVersion
+            && getNumber(position, end, header[1]) && header[1] == key.hashes[0]
+            && getNumber(position, end, header[2]) && header[2] == key.hashes[1]
+            && getNumber(position, end, header[3]) && header[3] == key.fileSize
+            && getString(position, end, optionTag) && optionTag == key.optionTag
+            && getNumber(position, end, isSatisfied)
+            && getNumber(position, end, statistics.decisionNum)
+            && getNumber(position, end, statistics.propagationNum)
+            && getNumber(position, end, statistics.conflictNum)
+            && getNumber(position, end, statistics.backtrackNum)
+            && getNumber(position, end, statistics.lookaheadNum)
+            && getNumber(position, end, statistics.failedLiteralNum)
+            && getNumber(position, end, maxDecisionDepth)
+            && getNumber(position, end, statistics.preprocessTime)
+            && getNumber(position, end, statistics.propagationTime)
+            && getNumber(position, end, statistics.branchingTime)
+            && getNumber(position, end, statistics.solveTime)
+            && getString(position, end, entry.text)
+            && getString(position, end, entry.modelText)
+            && position == end;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!isFound) {
+        if (data.empty())
+            forget(name);
+        ++missNum;
+        return false;
+    }
+    entry.isSatisfied = isSatisfied != 0;
+    statistics.maxDecisionDepth = static_cast<unsigned>(maxDecisionDepth);
+    touch(name, data.size());
+    ++hitNum;
+    return true;
+}
+
+//the file is written without the lock, only the index is updated with it
+bool CNFResultCache::store(const Key &key, const Entry &entry) {
+    TRACE_SCOPE("CNFResultCache::store");
+    std::vector<char> buffer(entryMagic, entryMagic + sizeof(entryMagic));
+    putNumber(buffer, resultVersion);
+    putNumber(buffer, key.hashes[0]);
+    putNumber(buffer, key.hashes[1]);
+    putNumber(buffer, key.fileSize);
+    putString(buffer, key.optionTag);
+    putNumber(buffer, entry.isSatisfied);
+    putNumber(buffer, entry.statistics.decisionNum);
+    putNumber(buffer, entry.statistics.propagationNum);
+    putNumber(buffer, entry.statistics.conflictNum);
+    putNumber(buffer, entry.statistics.backtrackNum);
+    putNumber(buffer, entry.statistics.lookaheadNum);
+    putNumber(buffer, entry.statistics.failedLiteralNum);
+    putNumber(buffer, entry.statistics.maxDecisionDepth);
+    putNumber(buffer, entry.statistics.preprocessTime);
+    putNumber(buffer, entry.statistics.propagationTime);
+    putNumber(buffer, entry.statistics.branchingTime);
+    putNumber(buffer, entry.statistics.solveTime);
+    putString(buffer, entry.text);
+    putString(buffer, entry.modelText);
+    if (buffer.size() > capacity)
+        return false;
+
+    std::string name = key.getName();
+    std::string path;
+    std::string temporaryPath;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (directory.empty())
+            return false;
+        path = getPath(name);
+        temporaryPath = getPath(name + ".tmp" + std::to_string(temporaryNum++));
+    }
+    bool isWritten = writeFile(path, temporaryPath, buffer);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!isWritten)
+        return false;
+    touch(name, buffer.size());
+    evict();
+    saveIndex();
+    return true;
+}
+
+void CNFResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const IndexEntry &entry : entries)
+        std::remove(getPath(entry.name).c_str());
+    entries.clear();
+    positions.clear();
+    size = 0;
+    hitNum = 0;
+    missNum = 0;
+    if (!directory.empty())
+        saveIndex();
+}
+
+unsigned long long CNFResultCache::getSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return size;
+}
+
+unsigned long long CNFResultCache::getHitNum() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitNum;
+}
+
+unsigned long long CNFResultCache::getMissNum() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missNum;
+}
+
+std::string CNFResultCache::getPath(const std::string &name) const {
+    return directory + name;
+}
+
+//a line for every entry from the least to the most recently used: name and size
+//entries of another version are removed, this build might not give their results
+void CNFResultCache::loadIndex() {
+    std::ifstream file(getPath(indexFileName));
+    std::string name;
+    unsigned long long entrySize;
+    std::string versionSuffix = getVersionSuffix();
+    bool hasRemovedEntries = false;
+    while (file >> name >> entrySize) {
+        if (name.size() > versionSuffix.size()
+                && name.compare(name.size() - versionSuffix.size(), versionSuffix.size(), versionSuffix) == 0)
+            touch(name, entrySize);
+        else {
+            std::remove(getPath(name).c_str());
+            hasRemovedEntries = true;
+        }
+    }
+    isIndexChanged = hasRemovedEntries;
+    evict();
+}
+
+void CNFResultCache::saveIndex() {
+    std::ostringstream index;
+    for (auto iter = entries.rbegin(); iter != entries.rend(); ++iter)
+        index << iter->name << ' ' << iter->size << '\n';
+    std::string text = index.str();
+    if (writeFile(getPath(indexFileName), getPath(std::string(indexFileName) + ".tmp"), std::vector<char>(text.begin(), text.end())))
+        isIndexChanged = false;
+}
+
+void CNFResultCache::touch(const std::string &name, unsigned long long entrySize) {
+    auto position = positions.find(name);
+    if (position != positions.end()) {
+        size -= position->second->size;
+        position->second->size = entrySize;
+        entries.splice(entries.begin(), entries, position->second);
+    }
+    else {
+        entries.push_front(IndexEntry{name, entrySize});
+        positions[name] = entries.begin();
+    }
+    size += entrySize;
+    isIndexChanged = true;
+}
+
+void CNFResultCache::forget(const std::string &name) {
+    auto position = positions.find(name);
+    if (position == positions.end())
+        return;
+    size -= position->second->size;
+    entries.erase(position->second);
+    positions.erase(position);
+    isIndexChanged = true;
+}
+
+void CNFResultCache::evict() {
+    while (size > capacity && !entries.empty()) {
+        std::remove(getPath(entries.back().name).c_str());
+        forget(entries.back().name);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef CNFRESULTCACHE_H
+#define CNFRESULTCACHE_H
+
+#include "CNFSolver.h"
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+//results of CNF solves kept on disk, keyed on a hash of the bytes of the file, on the options the result depends on
+//and on the version of the solvers, so a file submitted again under any name is answered without parsing or solving it
+//every entry is a file of the cache directory written to a temporary file and renamed, so no reader sees half of one,
+//and an index of the entries orders them by use, the least recently used entry is evicted once they take more than the capacity
+//the solver jobs of a process share the cache through its lock, files of the directory missing from the index are adopted when found
+class CNFResultCache {
+
+public:
+
+    struct Key {
+        unsigned long long hashes[2]; //two independent hashes of the bytes of the file
+        unsigned long long fileSize;
+        std::string optionTag; //the options the result depends on
+
+        std::string getName() const; //file name of the entry, which ends with the result version
+    };
+
+    struct Entry {
+        bool isSatisfied;
+        CNFSolver::Statistics statistics;
+        std::string text; //result text without the lines naming files
+        std::string modelText; //models written to the model file, empty when they are in the text
+
+        Entry() : isSatisfied(false) {}
+    };
+
+    explicit CNFResultCache(unsigned long long capacity = 256ULL << 20);
+    ~CNFResultCache(); //the order of the entries is saved for the next run
+    static CNFResultCache &getInstance(); //the cache used by the solver jobs
+    static bool makeKey(const std::string &, const std::string &, Key &); //file name and option tag, false when the file cannot be read
+    void setDirectory(const std::string &); //an existing directory, whose entries are kept, or empty to disable the cache
+    bool isEnabled() const;
+    bool find(const Key &, Entry &);
+    bool store(const Key &, const Entry &); //false when the entry cannot be written or is larger than the capacity
+    void clear(); //remove all the entries and reset the counters
+    unsigned long long getCapacity() const;
+    unsigned long long getSize() const; //bytes of all the entries
+    unsigned long long getHitNum() const;
+    unsigned long long getMissNum() const;
+
+    //disable all the unused functions
+    CNFResultCache(const CNFResultCache &) = delete;
+    CNFResultCache(CNFResultCache &&) = delete;
+    CNFResultCache &operator=(const CNFResultCache &) = delete;
+    CNFResultCache &operator=(CNFResultCache &&) = delete;
+
+private:
+
+    struct IndexEntry {
+        std::string name;
+        unsigned long long size;
+    };
+
+    mutable std::mutex mutex;
+    std::string directory;
+    unsigned long long capacity;
+    unsigned long long size;
+    //front of the list is the most recently used entry
+    std::list<IndexEntry> entries;
+    std::unordered_map<std::string, std::list<IndexEntry>::iterator> positions;
+    bool isIndexChanged;
+    unsigned long long temporaryNum; //makes the temporary files of concurrent stores differ
+    unsigned long long hitNum;
+    unsigned long long missNum;
+
+    //call them with the lock held
+    std::string getPath(const std::string &) const;
+    void loadIndex();
+    void saveIndex();
+    void touch(const std::string &, unsigned long long); //add or move an entry to the front
+    void forget(const std::string &);
+    void evict();
+};
+
+inline unsigned long long CNFResultCache::getCapacity() const {
+    return capacity;
+}
+
+#endif // CNFRESULTCACHE_H
@@ -1,224 +1,468 @@
 #include "CNFSolver.h"
-#include <string>
-#include <sstream>
+#include "Trace.h"
+#include "CNFFeatures.h"
+#include "CheckpointWriter.h"
+#include "DratWriter.h"
+#include "SudokuCache.h"
+#include "TextFormatter.h"
+#include "XorMatrix.h"
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 
-CNFSolver::CNFSolver(std::istream &input, bool selectedBranchingRule)
-    : originalClauseNum(0),
-      currentClauseNum(0),
-      clausesInfo(nullptr),
-      variableNum(0),
-      variablesInfo(nullptr),
-      getBranchingLiteral(nullptr),
-      originalMaxClauseLength(0),
-      hasEmptyClause(false) {
-    std::string line;
-    while (getline(input, line)) {
-        if (line.front() == 'p') {
-             std::stringstream ss(line);
-             std::string p, cnf;
-             unsigned variableNum, clauseNum;
-             ss >> p >> cnf >> variableNum >> clauseNum;
-             this->variableNum = variableNum;
-             currentClauseNum = originalClauseNum = clauseNum;
-             break;
+namespace {
+
+    const char checkpointMagic[8] = {'D', 'P', 'L', 'L', 'S', 'N', 'A', 'P'};
+    const unsigned long long checkpointVersion = 1;
+
+    //FNV-1a
+    unsigned long long addHash(unsigned long long hash, unsigned long long value) {
+        for (unsigned i = 0; i < 8; ++i) {
+            hash ^= (value >> (8 * i)) & 255;
+            hash *= 1099511628211ULL;
         }
+        return hash;
     }
 
-    //clause index is from 0 to originalClauseNum - 1
-    clausesInfo = new ClauseInfo[originalClauseNum];
-
-    //variable index is from 1 to variableNum
-    //variablesInfo[0] is not used
-    variablesInfo = new VariableInfo[variableNum + 1];
+    //variable-length numbers as in binary DRAT, 7 bits per byte with the high bit set on all but the last
+    void putNumber(std::vector<char> &buffer, unsigned long long value) {
+        while (value > 127) {
+            buffer.push_back(static_cast<char>(128 | (value & 127)));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
 
-    getBranchingLiteral = selectedBranchingRule ? &CNFSolver::getMOMSBranchingLiteral : &CNFSolver::getDLCSBranchingLiteral;
+    void putLiteral(std::vector<char> &buffer, int literal) {
+        putNumber(buffer, 2 * static_cast<unsigned long long>(std::abs(literal)) + (literal < 0));
+    }
 
-    int literal;
-    for (unsigned i = 0; i < originalClauseNum; ++i) {
-        while (input >> literal) {
-            if (literal == 0) {
-                if (clausesInfo[i].literals.size() == 1)
-                    if (!unitClauseLiteralsToAssign.doesContain(clausesInfo[i].literals.front()))
-                        unitClauseLiteralsToAssign.addBack(clausesInfo[i].literals.front());
-                break;
-            }
-            if (!clausesInfo[i].literals.doesContain(literal)) {
-                clausesInfo[i].literals.addBack(literal);
-                if (literal > 0)
-                    variablesInfo[literal].positiveOccur.addBack(i);
-                else
-                    variablesInfo[-literal].negativeOccur.addBack(i);
-            }
+    bool getNumber(const char *&position, const char *end, unsigned long long &value) {
+        value = 0;
+        for (unsigned shift = 0; position != end && shift < 64; shift += 7) {
+            unsigned char byte = static_cast<unsigned char>(*position++);
+            value |= static_cast<unsigned long long>(byte & 127) << shift;
+            if (byte < 128)
+                return true;
         }
+        return false;
+    }
+
+    bool getLiteral(const char *&position, const char *end, unsigned variableNum, int &literal) {
+        unsigned long long value;
+        if (!getNumber(position, end, value) || value / 2 == 0 || value / 2 > variableNum)
+            return false;
+        literal = (value & 1) != 0 ? -static_cast<int>(value / 2) : static_cast<int>(value / 2);
+        return true;
     }
+
 }
 
-CNFSolver::CNFSolver(unsigned sudoku[][10])
-    : originalClauseNum(11988), //8829
-      currentClauseNum(11988),
-      clausesInfo(new ClauseInfo[originalClauseNum]),
-      variableNum(729),
+CNFSolver::CNFSolver(std::istream &input, BranchingRule selectedBranchingRule)
+    : CNFSolver(CNFFormula(input), selectedBranchingRule) {}
+
+CNFSolver::CNFSolver(const CNFFormula &formula, BranchingRule selectedBranchingRule)
+    : CNFSolver(std::make_shared<const CNFInstance>(formula), selectedBranchingRule) {}
+
+CNFSolver::CNFSolver(std::shared_ptr<const CNFInstance> sharedInstance, BranchingRule selectedBranchingRule)
+    : instance(std::move(sharedInstance)),
+      originalClauseNum(instance->getClauseNum() - instance->getBinaryClauseNum()),
+      currentClauseNum(instance->getClauseNum()),
+      clauseStates(new ClauseState[originalClauseNum]),
+      twoLiteralClauses(nullptr),
+      threeLiteralClauses(nullptr),
+      occurOffsets(instance->getOccurOffsets()),
+      occurClauses(instance->getOccurClauses()),
+      implicationOffsets(instance->getImplicationOffsets()),
+      implicationLiterals(instance->getImplicationLiterals()),
+      truePartnerNums(implicationOffsets != nullptr ? new unsigned[2 * instance->getVariableNum() + 2]() : nullptr),
+      variableNum(instance->getVariableNum()),
       variablesInfo(new VariableInfo[variableNum + 1]),
-      getBranchingLiteral(&CNFSolver::getMOMSBranchingLiteral),
+      originalVariables(instance->getOriginalVariables()),
+      renumberedVariables(instance->getRenumberedVariables()),
+      groupNum(instance->getGroupNum()),
+      groupOffsets(instance->getGroupOffsets()),
+      groupVariables(instance->getGroupVariables()),
+      groupTrueNums(groupNum != 0 ? new unsigned[groupNum]() : nullptr),
+      variableGroupOffsets(instance->getVariableGroupOffsets()),
+      variableGroups(instance->getVariableGroups()),
+      branchingRule(selectedBranchingRule != Auto ? selectedBranchingRule
+                                                  : CNFFeatures(*instance).getConfiguration().branchingRule),
+      getBranchingLiteral(nullptr),
+      lookaheadCandidates(nullptr),
+      lookaheadTrail(nullptr),
+      necessaryLiterals(nullptr),
+      lookaheadStamps(nullptr),
+      lookaheadStamp(0),
       originalMaxClauseLength(0),
-      hasEmptyClause(false) {
-    int sudokuVariable[10][10][10];
-    int base = 0;
+      hasEmptyClause(false),
+      stopFlag(nullptr),
+      hasStopped(false),
+      progressInterval(std::chrono::milliseconds(200)),
+      checkpointWriter(nullptr),
+      checkpointInterval(std::chrono::seconds(60)),
+      isResumed(false),
+      isEnumerating(false),
+      modelLimit(0),
+      modelNum(0),
+      isEnumerationExhausted(false),
+      xorMatrix(instance->getXorMatrix() != nullptr ? new XorMatrix(*instance->getXorMatrix()) : nullptr),
+      proofWriter(nullptr),
+      proofClause(nullptr) {
+    TRACE_SCOPE("CNFSolver::CNFSolver(std::shared_ptr<const CNFInstance>)");
+    for (unsigned i = 0; i < originalClauseNum; ++i) {
+        clauseStates[i].activeLiteralNum = instance->getClauseLength(i);
+        clauseStates[i].isSatisfied = false;
+    }
+    for (int literal : instance->getUnitLiterals())
+        unitClauseLiteralsToAssign.addBack(literal);
+
+    if (branchingRule == Lookahead) {
+        lookaheadCandidates = new LookaheadCandidate[variableNum];
+        lookaheadTrail = new int[variableNum];
+        necessaryLiterals = new int[variableNum];
+        lookaheadStamps = new unsigned[2 * variableNum + 2]();
+    }
+}
+
+//the givens are unit clauses on the shared Sudoku instance
+CNFSolver::CNFSolver(unsigned sudoku[][10])
+    : CNFSolver(CNFInstance::getSudokuInstance(), MOMS) {
+    TRACE_SCOPE("CNFSolver::CNFSolver(unsigned [][10])");
     for (unsigned x = 1; x <= 9; ++x) {
         for (unsigned y = 1; y <= 9; ++y) {
-            for (unsigned z = 1; z <= 9; ++z)
-                sudokuVariable[x][y][z] = ++base;
             if (sudoku[x][y] != 0)
-                unitClauseLiteralsToAssign.addBack(sudokuVariable[x][y][sudoku[x][y]]);
+                unitClauseLiteralsToAssign.addBack(static_cast<int>(81 * (x - 1) + 9 * (y - 1) + sudoku[x][y]));
         }
     }
-    unsigned clauseIndex = static_cast<unsigned>(-1);
+}
 
-    //The minimal encoding is as below:
+CNFSolver::~CNFSolver() {
+    delete[] clauseStates;
+    delete[] twoLiteralClauses;
+    delete[] threeLiteralClauses;
+    delete[] truePartnerNums;
+    delete[] lookaheadCandidates;
+    delete[] lookaheadTrail;
+    delete[] necessaryLiterals;
+    delete[] lookaheadStamps;
+    delete xorMatrix;
+    delete[] variablesInfo;
+    delete[] groupTrueNums;
+    delete[] proofClause;
+}
 
-    //There is at least one number in each entry
-    for (unsigned x = 1; x <= 9; ++x) {
-        for (unsigned y = 1; y <= 9; ++y) {
-            ++clauseIndex;
-            for (unsigned z = 1; z <= 9; ++z) {
-                clausesInfo[clauseIndex].literals.addBack(sudokuVariable[x][y][z]);
-                variablesInfo[sudokuVariable[x][y][z]].positiveOccur.addBack(clauseIndex);
-            }
-        }
+bool CNFSolver::isSatisfied() {
+    using namespace std::chrono;
+
+    auto begin = steady_clock::now();
+    bool result = search();
+    statistics.solveTime += duration_cast<nanoseconds>(steady_clock::now() - begin).count();
+    return result;
+}
+
+//clauses of small fixed width are packed into aligned arrays after preprocessing
+template <>
+CNFSolver::PackedClause<2> *CNFSolver::getPackedClauses<2>() const {
+    return twoLiteralClauses;
+}
+
+template <>
+CNFSolver::PackedClause<3> *CNFSolver::getPackedClauses<3>() const {
+    return threeLiteralClauses;
+}
+
+template <unsigned Width>
+inline bool CNFSolver::isClauseSatisfied(unsigned clauseIndex) const {
+    return getPackedClauses<Width>()[clauseIndex].isSatisfied;
+}
+
+template <unsigned Width>
+inline void CNFSolver::setClauseSatisfied(unsigned clauseIndex, bool isSatisfied) {
+    getPackedClauses<Width>()[clauseIndex].isSatisfied = isSatisfied;
+}
+
+template <unsigned Width>
+inline unsigned CNFSolver::getClauseLength(unsigned clauseIndex) const {
+    return getPackedClauses<Width>()[clauseIndex].activeLiteralNum;
+}
+
+//the loop has a fixed trip count and no early exit, the first unassigned literal is kept
+//the slots repeating the last literal never bring a new one
+template <unsigned Width>
+inline int CNFSolver::getClauseFront(unsigned clauseIndex) const {
+    const PackedClause<Width> &clause = getPackedClauses<Width>()[clauseIndex];
+    int front = clause.literals[Width - 1];
+    for (unsigned i = Width - 1; i-- > 0; )
+        front = variablesInfo[std::abs(clause.literals[i])].assignedStatus == VariableInfo::None ? clause.literals[i] : front;
+    return front;
+}
+
+template <unsigned Width>
+inline void CNFSolver::removeClauseLiteral(unsigned clauseIndex) {
+    --getPackedClauses<Width>()[clauseIndex].activeLiteralNum;
+}
+
+template <unsigned Width>
+inline void CNFSolver::restoreClauseLiteral(unsigned clauseIndex) {
+    ++getPackedClauses<Width>()[clauseIndex].activeLiteralNum;
+}
+
+template <>
+inline bool CNFSolver::isClauseSatisfied<0>(unsigned clauseIndex) const {
+    return clauseStates[clauseIndex].isSatisfied;
+}
+
+template <>
+inline void CNFSolver::setClauseSatisfied<0>(unsigned clauseIndex, bool isSatisfied) {
+    clauseStates[clauseIndex].isSatisfied = isSatisfied;
+}
+
+template <>
+inline unsigned CNFSolver::getClauseLength<0>(unsigned clauseIndex) const {
+    return clauseStates[clauseIndex].activeLiteralNum;
+}
+
+//the literals of a clause are never moved, the last active one is the one left unassigned
+template <>
+inline int CNFSolver::getClauseFront<0>(unsigned clauseIndex) const {
+    const int *literals = instance->getClauseLiterals(clauseIndex);
+    unsigned length = instance->getClauseLength(clauseIndex);
+    for (unsigned i = 0; i < length; ++i) {
+        if (variablesInfo[std::abs(literals[i])].assignedStatus == VariableInfo::None)
+            return literals[i];
     }
-    //Each number appears at most once in each row
-    for (unsigned y = 1; y <= 9; ++y) {
-        for (unsigned z = 1; z <= 9; ++z) {
-            for (unsigned x = 1; x <= 8; ++x) {
-                for (unsigned i = x + 1; i <= 9; ++i) {
-                    ++clauseIndex;
-                    clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[x][y][z]);
-                    clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[i][y][z]);
-                    variablesInfo[sudokuVariable[x][y][z]].negativeOccur.addBack(clauseIndex);
-                    variablesInfo[sudokuVariable[i][y][z]].negativeOccur.addBack(clauseIndex);
-                }
+    return 0;
+}
+
+//a literal is removed from a clause by assigning its variable, so only the count has to follow
+template <>
+inline void CNFSolver::removeClauseLiteral<0>(unsigned clauseIndex) {
+    --clauseStates[clauseIndex].activeLiteralNum;
+}
+
+template <>
+inline void CNFSolver::restoreClauseLiteral<0>(unsigned clauseIndex) {
+    ++clauseStates[clauseIndex].activeLiteralNum;
+}
+
+//copy the clauses left by preprocessing, the literals assigned there stay false and are left out
+template <unsigned Width>
+CNFSolver::PackedClause<Width> *CNFSolver::packClauses() const {
+    PackedClause<Width> *packedClauses = new PackedClause<Width>[originalClauseNum];
+    for (unsigned i = 0; i < originalClauseNum; ++i) {
+        PackedClause<Width> &packedClause = packedClauses[i];
+        packedClause.activeLiteralNum = static_cast<unsigned char>(clauseStates[i].activeLiteralNum);
+        packedClause.isSatisfied = clauseStates[i].isSatisfied;
+        unsigned literalNum = 0;
+        if (!clauseStates[i].isSatisfied) {
+            const int *literals = instance->getClauseLiterals(i);
+            for (unsigned j = 0; j < instance->getClauseLength(i); ++j) {
+                if (variablesInfo[std::abs(literals[j])].assignedStatus == VariableInfo::None)
+                    packedClause.literals[literalNum++] = literals[j];
             }
         }
+        for (unsigned j = literalNum; j < Width; ++j)
+            packedClause.literals[j] = literalNum != 0 ? packedClause.literals[literalNum - 1] : 0;
     }
-    //Each number appears at most once in each column
-    for (unsigned x = 1; x <= 9; ++x) {
-        for (unsigned z = 1; z <= 9; ++z) {
-            for (unsigned y = 1; y <= 8; ++y) {
-                for (unsigned i = y + 1; i <= 9; ++i) {
-                    ++clauseIndex;
-                    clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[x][y][z]);
-                    clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[x][i][z]);
-                    variablesInfo[sudokuVariable[x][y][z]].negativeOccur.addBack(clauseIndex);
-                    variablesInfo[sudokuVariable[x][i][z]].negativeOccur.addBack(clauseIndex);
-                }
-            }
-        }
+    return packedClauses;
+}
+
+inline bool CNFSolver::isLiteralTrue(int literal) const {
+    return variablesInfo[std::abs(literal)].assignedStatus == (literal > 0 ? VariableInfo::True : VariableInfo::False);
+}
+
+//binary clauses keep no state: a true literal satisfies its clauses whose other literal is not true yet,
+//and the other literals of the clauses of a false literal are implied
+//the clauses are counted again by undoBinaryClauses, which sees the same other literals in reverse order
+//every literal counts its true partners, so the heuristics find the open clauses of a free literal without reading them
+inline void CNFSolver::applyBinaryClauses(int literal) {
+    if (implicationOffsets == nullptr)
+        return;
+    unsigned satisfyIndex = 2 * std::abs(literal) + (literal < 0);
+    unsigned implyIndex = satisfyIndex ^ 1;
+    for (unsigned i = implicationOffsets[satisfyIndex]; i < implicationOffsets[satisfyIndex + 1]; ++i) {
+        int partner = implicationLiterals[i];
+        currentClauseNum -= !isLiteralTrue(partner);
+        ++truePartnerNums[2 * std::abs(partner) + (partner < 0)];
     }
-    //Each number appears at most once in each 3x3 sub-grid
-    for (unsigned z = 1; z <= 9; ++z) {
-        for (unsigned i = 0; i <= 2; ++i) {
-            for (unsigned j = 0; j <= 2; ++j) {
-                for (unsigned x = 1; x <= 3; ++x) {
-                    for (unsigned y = 1; y <= 3; ++y) {
-                        for (unsigned k = y + 1; k <= 3; ++k) {
-                            ++clauseIndex;
-                            clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[3 * i + x][3 * j + y][z]);
-                            clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[3 * i + x][3 * j + k][z]);
-                            variablesInfo[sudokuVariable[3 * i + x][3 * j + y][z]].negativeOccur.addBack(clauseIndex);
-                            variablesInfo[sudokuVariable[3 * i + x][3 * j + k][z]].negativeOccur.addBack(clauseIndex);
-                        }
-                        for (unsigned k = x + 1; k <= 3; ++k) {
-                            for (unsigned l = 1; l <= 3; ++l) {
-                                ++clauseIndex;
-                                clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[3 * i + x][3 * j + y][z]);
-                                clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[3 * i + k][3 * j + l][z]);
-                                variablesInfo[sudokuVariable[3 * i + x][3 * j + y][z]].negativeOccur.addBack(clauseIndex);
-                                variablesInfo[sudokuVariable[3 * i + k][3 * j + l][z]].negativeOccur.addBack(clauseIndex);
-                            }
-                        }
-                    }
-                }
-            }
+    for (unsigned i = implicationOffsets[implyIndex]; i < implicationOffsets[implyIndex + 1] && !hasEmptyClause; ++i) {
+        int impliedLiteral = implicationLiterals[i];
+        if (variablesInfo[std::abs(impliedLiteral)].assignedStatus == VariableInfo::None) {
+            if (!unitClauseLiteralsToAssign.doesContain(impliedLiteral))
+                unitClauseLiteralsToAssign.addBack(impliedLiteral);
         }
+        else if (!isLiteralTrue(impliedLiteral))
+            hasEmptyClause = true;
+    }
+}
+
+inline void CNFSolver::undoBinaryClauses(int literal) {
+    if (implicationOffsets == nullptr)
+        return;
+    unsigned satisfyIndex = 2 * std::abs(literal) + (literal < 0);
+    for (unsigned i = implicationOffsets[satisfyIndex]; i < implicationOffsets[satisfyIndex + 1]; ++i) {
+        int partner = implicationLiterals[i];
+        currentClauseNum += !isLiteralTrue(partner);
+        --truePartnerNums[2 * std::abs(partner) + (partner < 0)];
     }
+}
 
-    //The extended encoding is as below:
+//binary clauses of a free literal not satisfied by the other literal, the other literal is free as well after propagation
+inline unsigned CNFSolver::getOpenBinaryClauseNum(unsigned literalIndex) const {
+    if (implicationOffsets == nullptr)
+        return 0;
+    return implicationOffsets[literalIndex + 1] - implicationOffsets[literalIndex] - truePartnerNums[literalIndex];
+}
 
-    //There is at most one number in each entry
-    for (unsigned x = 1; x <= 9; ++x) {
-        for (unsigned y = 1; y <= 9; ++y) {
-            for (unsigned z = 1; z <= 8; ++z) {
-                for (unsigned i = z + 1; i <= 9; ++i) {
-                    ++clauseIndex;
-                    clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[x][y][z]);
-                    clausesInfo[clauseIndex].literals.addBack(-sudokuVariable[x][y][i]);
-                    variablesInfo[sudokuVariable[x][y][z]].negativeOccur.addBack(clauseIndex);
-                    variablesInfo[sudokuVariable[x][y][i]].negativeOccur.addBack(clauseIndex);
-                }
-            }
-        }
+bool CNFSolver::search() {
+    using namespace std::chrono;
+
+    if (!canLogProof())
+        proofWriter = nullptr;
+
+    auto preprocessBegin = steady_clock::now();
+    ProcessResult preprocessResult = preprocess();
+    //literals implied by the XOR constraints are propagated like unit clauses
+    while (preprocessResult == Continued && xorMatrix != nullptr && xorMatrix->propagate(unitClauseLiteralsToAssign) > 0)
+        preprocessResult = preprocess();
+    //the initial elimination may already find the XOR constraints inconsistent
+    if (xorMatrix != nullptr && xorMatrix->hasConflict())
+        preprocessResult = Unsatisfied;
+    statistics.preprocessTime += duration_cast<nanoseconds>(steady_clock::now() - preprocessBegin).count();
+    if (preprocessResult == Unsatisfied) {
+        if (proofWriter != nullptr)
+            proofWriter->addClause(nullptr, 0);
+        return false;
     }
-    //Each number appears at least once in each row
-    for (unsigned y = 1; y <= 9; ++y) {
-        for (unsigned z = 1; z <= 9; ++z) {
-            ++clauseIndex;
-            for (unsigned x = 1; x <= 9; ++x) {
-                clausesInfo[clauseIndex].literals.addBack(sudokuVariable[x][y][z]);
-                variablesInfo[sudokuVariable[x][y][z]].positiveOccur.addBack(clauseIndex);
-            }
-        }
+
+    //formulas left with clauses of at most three literals get the fixed-width kernels
+    bool result = preprocessResult == Satisfied;
+    if (!result && originalMaxClauseLength <= 2) {
+        twoLiteralClauses = packClauses<2>();
+        result = branchAndPropagate<2>();
     }
-    //Each number appears at least once in each column
-    for (unsigned x = 1; x <= 9; ++x) {
-        for (unsigned z = 1; z <= 9; ++z) {
-            ++clauseIndex;
-            for (unsigned y = 1; y <= 9; ++y) {
-                clausesInfo[clauseIndex].literals.addBack(sudokuVariable[x][y][z]);
-                variablesInfo[sudokuVariable[x][y][z]].positiveOccur.addBack(clauseIndex);
-            }
-        }
+    else if (!result && originalMaxClauseLength == 3) {
+        threeLiteralClauses = packClauses<3>();
+        result = branchAndPropagate<3>();
     }
-    //Each number appears at least once in each 3x3 sub-grid
-    for (unsigned i = 0; i <= 2; ++i) {
-        for (unsigned j = 0; j <= 2; ++j) {
-            for (unsigned z = 1; z <= 9; ++z) {
-                ++clauseIndex;
-                for (unsigned x = 1; x <= 3; ++x) {
-                    for (unsigned y = 1; y <= 3; ++y) {
-                            clausesInfo[clauseIndex].literals.addBack(sudokuVariable[3 * i + x][3 * j + y][z]);
-                            variablesInfo[sudokuVariable[3 * i + x][3 * j + y][z]].positiveOccur.addBack(clauseIndex);
-                        }
-                    }
-                }
+    else if (!result)
+        result = branchAndPropagate<0>();
+    if (result && xorMatrix != nullptr)
+        assignXorModel();
+    if (result && groupNum != 0)
+        assignGroupModel();
+    return result;
+}
+
+//the XOR constraints are consistent when all the clauses are satisfied, so they have a solution
+//with the remaining variables, which is written to them without any propagation
+void CNFSolver::assignXorModel() {
+    int *literals = new int[variableNum]; //array size decided by variableNum
+    unsigned literalNum = xorMatrix->getModelLiterals(literals);
+    for (unsigned i = 1; i <= variableNum; ++i) {
+        if (variablesInfo[i].assignedStatus == VariableInfo::None && xorMatrix->hasVariable(i))
+            variablesInfo[i].assignedStatus = VariableInfo::False;
+    }
+    for (unsigned i = 0; i < literalNum; ++i)
+        variablesInfo[std::abs(literals[i])].assignedStatus = literals[i] > 0 ? VariableInfo::True : VariableInfo::False;
+    delete[] literals;
+}
+
+//one counter per group: a second true variable is a conflict, the first one makes all the others false
+void CNFSolver::applyGroupAssignment(unsigned variable) {
+    for (unsigned i = variableGroupOffsets[variable]; i < variableGroupOffsets[variable + 1]; ++i) {
+        unsigned group = variableGroups[i];
+        if (groupTrueNums[group]++ != 0) {
+            hasEmptyClause = true;
+            continue;
+        }
+        for (unsigned j = groupOffsets[group]; j < groupOffsets[group + 1] && !hasEmptyClause; ++j) {
+            unsigned member = groupVariables[j];
+            int falseLiteral = -static_cast<int>(member);
+            if (member != variable && variablesInfo[member].assignedStatus == VariableInfo::None
+                    && !unitClauseLiteralsToAssign.doesContain(falseLiteral))
+                unitClauseLiteralsToAssign.addBack(falseLiteral);
         }
     }
 }
 
-CNFSolver::~CNFSolver() {
-    delete[] clausesInfo;
-    delete[] variablesInfo;
+void CNFSolver::undoGroupAssignment(unsigned variable) {
+    for (unsigned i = variableGroupOffsets[variable]; i < variableGroupOffsets[variable + 1]; ++i)
+        --groupTrueNums[variableGroups[i]];
 }
 
-bool CNFSolver::isSatisfied() {
-    ProcessResult preprocessResult = preprocess();
-    if (preprocessResult == Satisfied)
-        return true;
-    if (preprocessResult == Unsatisfied)
-        return false;
+//no group has two true variables when all the clauses are satisfied, so the free ones can be false
+void CNFSolver::assignGroupModel() {
+    for (unsigned i = 0; i < groupOffsets[groupNum]; ++i) {
+        if (variablesInfo[groupVariables[i]].assignedStatus == VariableInfo::None)
+            variablesInfo[groupVariables[i]].assignedStatus = VariableInfo::False;
+    }
+}
+
+//Width is the packed clause width, or 0 for the general clauseStates
+template <unsigned Width>
+bool CNFSolver::branchAndPropagate() {
+    using namespace std::chrono;
+
+    switch (branchingRule) {
+    case DLCS:
+        getBranchingLiteral = &CNFSolver::getDLCSBranchingLiteral<Width>;
+        break;
+    case MOMS:
+        getBranchingLiteral = &CNFSolver::getMOMSBranchingLiteral<Width>;
+        break;
+    case Lookahead:
+    case Auto: //resolved by the constructor
+        getBranchingLiteral = &CNFSolver::getLookaheadBranchingLiteral<Width>;
+        break;
+    }
+
+    if (isResumed)
+        replayCheckpoint<Width>();
 
     int currentBranchingLiteral = 0;
     while (true) {
         if (hasEmptyClause) {
             hasEmptyClause = false;
-            applyAssignment(currentBranchingLiteral);
+            if (xorMatrix != nullptr)
+                xorMatrix->pushLevel();
+            applyAssignment<Width>(currentBranchingLiteral);
             assignmentsInfo.addFront(AssignmentInfo(currentBranchingLiteral, true));
         }
-        else if ((currentBranchingLiteral = (this->*getBranchingLiteral)()) != 0) {
-            applyAssignment(currentBranchingLiteral);
-            assignmentsInfo.addFront(AssignmentInfo(currentBranchingLiteral, false));
+        else {
+            //the propagation is done here, so a snapshot or a stop leaves a consistent trail
+            if (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed)) {
+                hasStopped = true;
+                if (checkpointWriter != nullptr && !isEnumerating)
+                    writeCheckpoint(true);
+                return false;
+            }
+            if (checkpointWriter != nullptr && !isEnumerating && steady_clock::now() - lastCheckpointTime >= checkpointInterval) {
+                lastCheckpointTime = steady_clock::now();
+                writeCheckpoint(false);
+            }
+            auto branchingBegin = steady_clock::now();
+            currentBranchingLiteral = isEnumerating ? getProjectionBranchingLiteral<Width>() : (this->*getBranchingLiteral)();
+            auto branchingEnd = steady_clock::now();
+            statistics.branchingTime += duration_cast<nanoseconds>(branchingEnd - branchingBegin).count();
+            if (currentBranchingLiteral != 0) {
+                ++statistics.decisionNum;
+                if (xorMatrix != nullptr)
+                    xorMatrix->pushLevel();
+                applyAssignment<Width>(currentBranchingLiteral);
+                assignmentsInfo.addFront(AssignmentInfo(currentBranchingLiteral, false));
+            }
+            if (progressCallback && branchingEnd - lastProgressTime >= progressInterval) {
+                lastProgressTime = branchingEnd;
+                progressCallback(statistics);
+            }
         }
-        ProcessResult firstCheckResult = checkWithBacktracking(currentBranchingLiteral);
+        if (assignmentsInfo.size() > statistics.maxDecisionDepth)
+            statistics.maxDecisionDepth = assignmentsInfo.size();
+        ProcessResult firstCheckResult = checkWithBacktracking<Width>(currentBranchingLiteral);
+        if (firstCheckResult == Satisfied && isEnumerating)
+            firstCheckResult = processModel<Width>(currentBranchingLiteral);
         if (firstCheckResult == BacktrackingDone)
             continue;
         if (firstCheckResult == Satisfied)
@@ -226,210 +470,566 @@ bool CNFSolver::isSatisfied() {
         if (firstCheckResult == Unsatisfied)
             return false;
 
-        while (!unitClauseLiteralsToAssign.isEmpty()) {
+        auto propagationBegin = steady_clock::now();
+        ProcessResult secondCheckResult = Continued;
+        TRACE_SCOPE("CNFSolver::applyAssignment batch");
+        //the XOR constraints are propagated whenever the clauses reach a fixpoint
+        while (!unitClauseLiteralsToAssign.isEmpty()
+                   || (xorMatrix != nullptr && xorMatrix->propagate(unitClauseLiteralsToAssign) > 0)) {
             int unitClauseLiteral = unitClauseLiteralsToAssign.front();
             unitClauseLiteralsToAssign.removeFront();
-            applyAssignment(unitClauseLiteral);
+            applyAssignment<Width>(unitClauseLiteral);
+            ++statistics.propagationNum;
             assignmentsInfo.front().assignedUnitClauseLiterals.addFront(unitClauseLiteral);
-            ProcessResult secondCheckResult = checkWithBacktracking(currentBranchingLiteral);
-            if (secondCheckResult == BacktrackingDone)
+            secondCheckResult = checkWithBacktracking<Width>(currentBranchingLiteral);
+            if (secondCheckResult != Continued)
                 break;
-            if (secondCheckResult == Satisfied)
-                return true;
-            if (secondCheckResult == Unsatisfied)
-                return false;
         }
+        statistics.propagationTime += duration_cast<nanoseconds>(steady_clock::now() - propagationBegin).count();
+        if (secondCheckResult == Satisfied && isEnumerating)
+            secondCheckResult = processModel<Width>(currentBranchingLiteral);
+        if (secondCheckResult == Satisfied)
+            return true;
+        if (secondCheckResult == Unsatisfied)
+            return false;
     }
 }
 
-void CNFSolver::printSatisfiabilityInfo(std::ostream &output) {
-    using namespace std::chrono;
+bool CNFSolver::printSatisfiabilityInfo(std::ostream &output) {
+    return printSatisfiabilityInfo(output, output);
+}
 
-    auto begin = steady_clock::now();
+bool CNFSolver::printSatisfiabilityInfo(std::ostream &output, std::ostream &modelOutput) {
     bool result = isSatisfied();
-    auto end = steady_clock::now();
-    auto timeSpan = duration_cast<duration<unsigned, std::micro>>(end - begin);
-    output << "s " << result << std::endl;
-    if (result) {
-        output << "v ";
-        for (unsigned i = 1; i <= variableNum; ++i) {
-            switch (variablesInfo[i].assignedStatus) {
-            case VariableInfo::True:
-                output << i << ' ';
-                break;
-            case VariableInfo::False:
-                output << '-' << i << ' ';
-                break;
-            case VariableInfo::None:
-                output<< '[' << i << "] ";
-                break;
-            }
+    if (hasStopped)
+        output << "s UNKNOWN" << std::endl;
+    else
+        output << "s " << result << std::endl;
+    if (result)
+        printModel(modelOutput);
+    output << "t " << statistics.solveTime / 1000000.0 << std::endl;
+    printStatistics(output);
+    return result;
+}
+
+unsigned long long CNFSolver::enumerateModels(const std::vector<unsigned> &projection, unsigned long long limit, ModelCallback callback) {
+    isEnumerating = true;
+    isProjected.assign(variableNum + 1, projection.empty());
+    projectionVariables.clear();
+    for (unsigned variable : projection) {
+        if (variable < 1 || variable > variableNum)
+            continue;
+        if (renumberedVariables != nullptr)
+            variable = renumberedVariables[variable];
+        if (!isProjected[variable]) {
+            isProjected[variable] = true;
+            projectionVariables.push_back(variable);
+        }
+    }
+    if (projection.empty()) {
+        for (unsigned i = 1; i <= variableNum; ++i)
+            projectionVariables.push_back(renumberedVariables != nullptr ? renumberedVariables[i] : i);
+    }
+    modelLiterals.resize(projectionVariables.size());
+    modelCallback = std::move(callback);
+    modelLimit = limit;
+    modelNum = 0;
+    //the search only returns true when the enumeration was ended at a model
+    isEnumerationExhausted = !isSatisfied() && !hasStopped;
+    return modelNum;
+}
+
+unsigned long long CNFSolver::printModels(std::ostream &output, std::ostream &modelOutput,
+                                          const std::vector<unsigned> &projection, unsigned long long limit) {
+    TextFormatter formatter(modelOutput);
+    unsigned long long count = enumerateModels(projection, limit, [&formatter](const int *literals, unsigned literalNum) {
+        formatter.put('v');
+        for (unsigned i = 0; i < literalNum; ++i) {
+            formatter.put(' ');
+            formatter.putInteger(literals[i]);
+        }
+        formatter.put(' ');
+        formatter.put('0');
+        formatter.put('\n');
+        return true;
+    });
+    formatter.flush();
+    modelOutput.flush();
+    if (hasStopped)
+        output << "s UNKNOWN" << std::endl;
+    else
+        output << "s " << (count > 0) << std::endl;
+    output << "c models " << count << (isEnumerationComplete() ? "" : " at least") << std::endl;
+    output << "t " << statistics.solveTime / 1000000.0 << std::endl;
+    printStatistics(output);
+    return count;
+}
+
+bool CNFSolver::isEnumerationComplete() const {
+    return isEnumerationExhausted;
+}
+
+void CNFSolver::printModel(std::ostream &output) const {
+    TextFormatter formatter(output);
+    formatter.put('v');
+    formatter.put(' ');
+    for (unsigned i = 1; i <= variableNum; ++i) {
+        switch (variablesInfo[renumberedVariables != nullptr ? renumberedVariables[i] : i].assignedStatus) {
+        case VariableInfo::True:
+            formatter.putUnsigned(i);
+            formatter.put(' ');
+            break;
+        case VariableInfo::False:
+            formatter.put('-');
+            formatter.putUnsigned(i);
+            formatter.put(' ');
+            break;
+        case VariableInfo::None:
+            formatter.put('[');
+            formatter.putUnsigned(i);
+            formatter.put(']');
+            formatter.put(' ');
+            break;
+        }
+    }
+    formatter.put('\n');
+    formatter.flush();
+    output.flush();
+}
+
+void CNFSolver::printStatistics(std::ostream &output) const {
+    output << "c decisions " << statistics.decisionNum << std::endl;
+    output << "c propagations " << statistics.propagationNum << std::endl;
+    output << "c conflicts " << statistics.conflictNum << std::endl;
+    output << "c backtracks " << statistics.backtrackNum << std::endl;
+    if (branchingRule == Lookahead) {
+        output << "c lookaheads " << statistics.lookaheadNum << std::endl;
+        output << "c failed literals " << statistics.failedLiteralNum << std::endl;
+    }
+    output << "c max decision depth " << statistics.maxDecisionDepth << std::endl;
+    output << "c preprocess time " << statistics.preprocessTime / 1000000.0 << std::endl;
+    output << "c propagation time " << statistics.propagationTime / 1000000.0 << std::endl;
+    output << "c branching time " << statistics.branchingTime / 1000000.0 << std::endl;
+}
+
+const CNFSolver::Statistics &CNFSolver::getStatistics() const {
+    return statistics;
+}
+
+void CNFSolver::setProofWriter(DratWriter *writer) {
+    proofWriter = writer;
+    if (proofWriter != nullptr)
+        proofWriter->setVariableMap(originalVariables);
+    if (proofClause == nullptr)
+        proofClause = new int[variableNum + 1];
+}
+
+void CNFSolver::setStopFlag(const std::atomic<bool> *flag) {
+    stopFlag = flag;
+}
+
+bool CNFSolver::isStopped() const {
+    return hasStopped;
+}
+
+unsigned CNFSolver::getXorNum() const {
+    return xorMatrix != nullptr ? xorMatrix->getRowNum() : 0;
+}
+
+unsigned CNFSolver::getGroupNum() const {
+    return groupNum;
+}
+
+bool CNFSolver::canLogProof() const {
+    return instance->isProofSupported() && !isResumed && !isEnumerating;
+}
+
+void CNFSolver::setCheckpointWriter(CheckpointWriter *writer, unsigned intervalSeconds) {
+    checkpointWriter = writer;
+    checkpointInterval = std::chrono::seconds(intervalSeconds);
+    lastCheckpointTime = std::chrono::steady_clock::now();
+}
+
+//a snapshot is "DPLLSNAP" followed by variable-length numbers: the version, the variable and clause numbers,
+//the formula hash, the statistics, the literals assigned before the first branching,
+//then every decision level from the bottom: its branching literal, whether it was forced, its unit literals,
+//literals being 2 * variable + sign, and last the hash of all the bytes before it
+//nothing is learned by the search, so the trail is all it takes to go on from the same point
+void CNFSolver::writeCheckpoint(bool isLast) {
+    if (!isLast && checkpointWriter->isBusy())
+        return;
+    TRACE_SCOPE("CNFSolver::writeCheckpoint");
+    std::vector<char> &buffer = checkpointBuffer;
+    buffer.assign(checkpointMagic, checkpointMagic + sizeof(checkpointMagic));
+    putNumber(buffer, checkpointVersion);
+    putNumber(buffer, variableNum);
+    putNumber(buffer, instance->getClauseNum());
+    putNumber(buffer, instance->getFormulaHash());
+    putNumber(buffer, statistics.decisionNum);
+    putNumber(buffer, statistics.propagationNum);
+    putNumber(buffer, statistics.conflictNum);
+    putNumber(buffer, statistics.backtrackNum);
+    putNumber(buffer, statistics.lookaheadNum);
+    putNumber(buffer, statistics.failedLiteralNum);
+    putNumber(buffer, statistics.maxDecisionDepth);
+    putNumber(buffer, statistics.preprocessTime);
+    putNumber(buffer, statistics.propagationTime);
+    putNumber(buffer, statistics.branchingTime);
+    putNumber(buffer, statistics.solveTime);
+
+    //the stack has the top level at its front
+    std::vector<const AssignmentInfo *> levels;
+    std::vector<bool> isOnLevel(variableNum + 1, false);
+    auto levelIter = assignmentsInfo.iterator();
+    while (levelIter.isValid()) {
+        levels.push_back(&levelIter.element());
+        isOnLevel[std::abs(levelIter.element().assignedBranchingLiteral)] = true;
+        auto unitIter = levelIter.element().assignedUnitClauseLiterals.iterator();
+        while (unitIter.isValid()) {
+            isOnLevel[std::abs(unitIter.element())] = true;
+            unitIter.next();
+        }
+        levelIter.next();
+    }
+    unsigned rootLiteralNum = 0;
+    for (unsigned i = 1; i <= variableNum; ++i)
+        rootLiteralNum += variablesInfo[i].assignedStatus != VariableInfo::None && !isOnLevel[i];
+    putNumber(buffer, rootLiteralNum);
+    for (unsigned i = 1; i <= variableNum; ++i) {
+        if (variablesInfo[i].assignedStatus != VariableInfo::None && !isOnLevel[i])
+            putLiteral(buffer, variablesInfo[i].assignedStatus == VariableInfo::True ? static_cast<int>(i) : -static_cast<int>(i));
+    }
+    putNumber(buffer, levels.size());
+    std::vector<int> unitLiterals;
+    for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+        putLiteral(buffer, (*level)->assignedBranchingLiteral);
+        putNumber(buffer, (*level)->isForcedAssignment);
+        unitLiterals.clear();
+        auto unitIter = (*level)->assignedUnitClauseLiterals.iterator();
+        while (unitIter.isValid()) {
+            unitLiterals.push_back(unitIter.element());
+            unitIter.next();
+        }
+        putNumber(buffer, unitLiterals.size());
+        for (auto literal = unitLiterals.rbegin(); literal != unitLiterals.rend(); ++literal)
+            putLiteral(buffer, *literal);
+    }
+    unsigned long long hash = 14695981039346656037ULL;
+    for (char byte : buffer)
+        hash = addHash(hash, static_cast<unsigned char>(byte));
+    putNumber(buffer, hash);
+    checkpointWriter->write(buffer, isLast);
+}
+
+bool CNFSolver::resume(std::istream &input) {
+    std::vector<char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(checkpointMagic) || !std::equal(checkpointMagic, checkpointMagic + sizeof(checkpointMagic), data.begin()))
+        return false;
+    const char *position = data.data() + sizeof(checkpointMagic);
+    const char *end = data.data() + data.size();
+    unsigned long long header[4];
+    for (unsigned long long &value : header) {
+        if (!getNumber(position, end, value))
+            return false;
+    }
+    if (header[0] != checkpointVersion || header[1] != variableNum || header[2] != instance->getClauseNum() || header[3] != instance->getFormulaHash())
+        return false;
+
+    Statistics resumedStatistics;
+    unsigned long long maxDecisionDepth;
+    if (!getNumber(position, end, resumedStatistics.decisionNum)
+            || !getNumber(position, end, resumedStatistics.propagationNum)
+            || !getNumber(position, end, resumedStatistics.conflictNum)
+            || !getNumber(position, end, resumedStatistics.backtrackNum)
+            || !getNumber(position, end, resumedStatistics.lookaheadNum)
+            || !getNumber(position, end, resumedStatistics.failedLiteralNum)
+            || !getNumber(position, end, maxDecisionDepth)
+            || !getNumber(position, end, resumedStatistics.preprocessTime)
+            || !getNumber(position, end, resumedStatistics.propagationTime)
+            || !getNumber(position, end, resumedStatistics.branchingTime)
+            || !getNumber(position, end, resumedStatistics.solveTime))
+        return false;
+    resumedStatistics.maxDecisionDepth = static_cast<unsigned>(maxDecisionDepth);
+
+    //every variable is assigned at most once
+    std::vector<int> rootLiterals, levels;
+    std::vector<bool> isAssigned(variableNum + 1, false);
+    auto getNewLiteral = [&](int &literal) {
+        if (!getLiteral(position, end, variableNum, literal) || isAssigned[std::abs(literal)])
+            return false;
+        isAssigned[std::abs(literal)] = true;
+        return true;
+    };
+    unsigned long long rootLiteralNum, levelNum, isForced, unitLiteralNum;
+    int literal;
+    if (!getNumber(position, end, rootLiteralNum) || rootLiteralNum > variableNum)
+        return false;
+    for (unsigned long long i = 0; i < rootLiteralNum; ++i) {
+        if (!getNewLiteral(literal))
+            return false;
+        rootLiterals.push_back(literal);
+    }
+    if (!getNumber(position, end, levelNum) || levelNum > variableNum)
+        return false;
+    for (unsigned long long i = 0; i < levelNum; ++i) {
+        if (!getNewLiteral(literal) || !getNumber(position, end, isForced) || isForced > 1
+                || !getNumber(position, end, unitLiteralNum) || unitLiteralNum > variableNum)
+            return false;
+        levels.push_back(literal);
+        levels.push_back(static_cast<int>(isForced));
+        levels.push_back(static_cast<int>(unitLiteralNum));
+        for (unsigned long long j = 0; j < unitLiteralNum; ++j) {
+            if (!getNewLiteral(literal))
+                return false;
+            levels.push_back(literal);
         }
-        output << std::endl;
     }
-    output << "t " << timeSpan.count() / 1000.0 << std::endl;
+    unsigned long long hash = 14695981039346656037ULL;
+    for (const char *byte = data.data(); byte != position; ++byte)
+        hash = addHash(hash, static_cast<unsigned char>(*byte));
+    unsigned long long storedHash;
+    if (!getNumber(position, end, storedHash) || storedHash != hash || position != end)
+        return false;
+
+    statistics = resumedStatistics;
+    resumedRootLiterals.swap(rootLiterals);
+    resumedLevels.swap(levels);
+    isResumed = true;
+    return true;
+}
+
+void CNFSolver::setProgressCallback(ProgressCallback callback, unsigned intervalMilliseconds) {
+    progressCallback = std::move(callback);
+    progressInterval = std::chrono::milliseconds(intervalMilliseconds);
+    lastProgressTime = std::chrono::steady_clock::now();
 }
 
 bool CNFSolver::solveSudoku(unsigned sudoku[][10]) {
+    //equivalent grids share one search through the cache,
+    //grids with fewer than 17 givens are never unique puzzles and practically never come again
+    unsigned givenCellNum = 0;
+    for (unsigned i = 1; i <= 9; ++i) {
+        for (unsigned j = 1; j <= 9; ++j)
+            givenCellNum += sudoku[i][j] != 0;
+    }
+    SudokuCache &cache = SudokuCache::getInstance();
+    SudokuCache::CanonicalForm form;
+    SudokuCache::Result result;
+    bool isCached = givenCellNum >= 17 && SudokuCache::canonicalize(sudoku, form);
+    if (isCached && cache.find(form, result) && (result.isSolved || result.isUnsolvable)) {
+        if (result.isSolved)
+            form.fromCanonical(result.solution, sudoku);
+        return result.isSolved;
+    }
+
     CNFSolver formula(sudoku);
     if (formula.isSatisfied()) {
         for (unsigned index = 1; index <= formula.variableNum; ++index) {
             if (formula.variablesInfo[index].assignedStatus == VariableInfo::True)
                 sudoku[(index - 1) / 81 + 1][(index - 1) / 9 % 9 + 1] = (index - 1) % 9 + 1;
         }
+        if (isCached)
+            cache.storeSolution(form, sudoku);
         return true;
     }
+    if (isCached)
+        cache.storeSolution(form, nullptr);
     return false;
 }
 
 CNFSolver::ProcessResult CNFSolver::preprocess() {
+    TRACE_SCOPE("CNFSolver::preprocess");
     while (!unitClauseLiteralsToAssign.isEmpty()) {
         int literal = unitClauseLiteralsToAssign.front();
         unitClauseLiteralsToAssign.removeFront();
+        ++statistics.propagationNum;
 
-        List<unsigned>::Iterator satisfyIter;
-        List<unsigned>::Iterator deleteIter;
-        if (literal > 0) {
-            variablesInfo[literal].assignedStatus = VariableInfo::True;
-            satisfyIter = variablesInfo[literal].positiveOccur.iterator();
-            deleteIter = variablesInfo[literal].negativeOccur.iterator();
-        }
-        else {
-            variablesInfo[-literal].assignedStatus = VariableInfo::False;
-            satisfyIter = variablesInfo[-literal].negativeOccur.iterator();
-            deleteIter = variablesInfo[-literal].positiveOccur.iterator();
+        unsigned variableIndex = std::abs(literal);
+        variablesInfo[variableIndex].assignedStatus = literal > 0 ? VariableInfo::True : VariableInfo::False;
+        if (xorMatrix != nullptr) {
+            xorMatrix->assign(variableIndex, literal > 0);
+            hasEmptyClause = xorMatrix->hasConflict();
         }
-        while (satisfyIter.isValid()) {
-            if (!clausesInfo[satisfyIter.element()].isSatisfied) {
-                clausesInfo[satisfyIter.element()].isSatisfied = true;
+        if (literal > 0 && groupNum != 0)
+            applyGroupAssignment(variableIndex);
+        applyBinaryClauses(literal);
+        unsigned satisfyIndex = 2 * variableIndex + (literal < 0);
+        unsigned deleteIndex = 2 * variableIndex + (literal > 0);
+        for (unsigned i = occurOffsets[satisfyIndex]; i < occurOffsets[satisfyIndex + 1]; ++i) {
+            if (!isClauseSatisfied<0>(occurClauses[i])) {
+                setClauseSatisfied<0>(occurClauses[i], true);
                 --currentClauseNum;
             }
-            satisfyIter.next();
         }
-        while (deleteIter.isValid()) {
-            unsigned clauseIndex = deleteIter.element();
-            if (!clausesInfo[clauseIndex].isSatisfied) {
-                clausesInfo[clauseIndex].literals.removeFirstOf(-literal);
+        for (unsigned i = occurOffsets[deleteIndex]; i < occurOffsets[deleteIndex + 1]; ++i) {
+            unsigned clauseIndex = occurClauses[i];
+            if (!isClauseSatisfied<0>(clauseIndex)) {
+                removeClauseLiteral<0>(clauseIndex);
                 //check whether it is a unit clause or empty clause
-                if (clausesInfo[clauseIndex].literals.size() == 0) {
+                if (getClauseLength<0>(clauseIndex) == 0) {
                     hasEmptyClause = true;
                     break;
                 }
-                if (clausesInfo[clauseIndex].literals.size() == 1)
-                    if (!unitClauseLiteralsToAssign.doesContain(clausesInfo[clauseIndex].literals.front()))
-                        unitClauseLiteralsToAssign.addBack(clausesInfo[clauseIndex].literals.front());
+                if (getClauseLength<0>(clauseIndex) == 1)
+                    if (!unitClauseLiteralsToAssign.doesContain(getClauseFront<0>(clauseIndex)))
+                        unitClauseLiteralsToAssign.addBack(getClauseFront<0>(clauseIndex));
             }
-            deleteIter.next();
         }
 
-        if (currentClauseNum == 0)
-            return Satisfied;
         if (hasEmptyClause)
             return Unsatisfied;
+        //an enumeration needs all the implied literals even when every clause is satisfied
+        if (currentClauseNum == 0 && !isEnumerating)
+            return Satisfied;
     }
     for (unsigned i = 0; i < originalClauseNum; ++i) {
-        if (!clausesInfo[i].isSatisfied && clausesInfo[i].literals.size() > originalMaxClauseLength)
-            originalMaxClauseLength = clausesInfo[i].literals.size();
+        if (!isClauseSatisfied<0>(i) && getClauseLength<0>(i) > originalMaxClauseLength)
+            originalMaxClauseLength = getClauseLength<0>(i);
     }
     return Continued;
 }
 
+template <unsigned Width>
 void CNFSolver::applyAssignment(int literal) {
-    List<unsigned>::Iterator satisfyIter;
-    List<unsigned>::Iterator deleteIter;
-    if (literal > 0) {
-        variablesInfo[literal].assignedStatus = VariableInfo::True;
-        satisfyIter = variablesInfo[literal].positiveOccur.iterator();
-        deleteIter = variablesInfo[literal].negativeOccur.iterator();
-    }
-    else {
-        variablesInfo[-literal].assignedStatus = VariableInfo::False;
-        satisfyIter = variablesInfo[-literal].negativeOccur.iterator();
-        deleteIter = variablesInfo[-literal].positiveOccur.iterator();
-    }
-    while (satisfyIter.isValid()) {
-        if (!clausesInfo[satisfyIter.element()].isSatisfied) {
-            clausesInfo[satisfyIter.element()].isSatisfied = true;
-            variablesInfo[std::abs(literal)].satisfiedOccur.addFront(satisfyIter.element());
+    unsigned variableIndex = std::abs(literal);
+    variablesInfo[variableIndex].assignedStatus = literal > 0 ? VariableInfo::True : VariableInfo::False;
+    //a conflict of the XOR constraints is handled like an empty clause
+    if (xorMatrix != nullptr) {
+        xorMatrix->assign(variableIndex, literal > 0);
+        hasEmptyClause = hasEmptyClause || xorMatrix->hasConflict();
+    }
+    if (literal > 0 && groupNum != 0)
+        applyGroupAssignment(variableIndex);
+    applyBinaryClauses(literal);
+    unsigned satisfyIndex = 2 * variableIndex + (literal < 0);
+    unsigned deleteIndex = 2 * variableIndex + (literal > 0);
+    for (unsigned i = occurOffsets[satisfyIndex]; i < occurOffsets[satisfyIndex + 1]; ++i) {
+        unsigned clauseIndex = occurClauses[i];
+        if (!isClauseSatisfied<Width>(clauseIndex)) {
+            setClauseSatisfied<Width>(clauseIndex, true);
+            variablesInfo[variableIndex].satisfiedOccur.addFront(clauseIndex);
             --currentClauseNum;
         }
-        satisfyIter.next();
     }
-    while (deleteIter.isValid()) {
-        unsigned clauseIndex = deleteIter.element();
-        if (!clausesInfo[clauseIndex].isSatisfied) {
-            clausesInfo[clauseIndex].literals.removeFirstOf(-literal);
-            variablesInfo[std::abs(literal)].deletedOccur.addFront(clauseIndex);
+    for (unsigned i = occurOffsets[deleteIndex]; i < occurOffsets[deleteIndex + 1]; ++i) {
+        unsigned clauseIndex = occurClauses[i];
+        if (!isClauseSatisfied<Width>(clauseIndex)) {
+            removeClauseLiteral<Width>(clauseIndex);
+            variablesInfo[variableIndex].deletedOccur.addFront(clauseIndex);
 
             //check whether it is a unit clause or empty clause
-            if (clausesInfo[clauseIndex].literals.size() == 0) {
+            unsigned length = getClauseLength<Width>(clauseIndex);
+            if (length == 0) {
                 hasEmptyClause = true;
                 break;
             }
-            if (clausesInfo[clauseIndex].literals.size() == 1) {
-                if (!unitClauseLiteralsToAssign.doesContain(clausesInfo[clauseIndex].literals.front()))
-                    unitClauseLiteralsToAssign.addBack(clausesInfo[clauseIndex].literals.front());
+            if (length == 1) {
+                if (!unitClauseLiteralsToAssign.doesContain(getClauseFront<Width>(clauseIndex)))
+                    unitClauseLiteralsToAssign.addBack(getClauseFront<Width>(clauseIndex));
             }
         }
-        deleteIter.next();
     }
 }
 
+template <unsigned Width>
 void CNFSolver::undoAssignment(int literal) {
     auto variableIndex = std::abs(literal);
     variablesInfo[variableIndex].assignedStatus = VariableInfo::None;
+    if (literal > 0 && groupNum != 0)
+        undoGroupAssignment(variableIndex);
+    undoBinaryClauses(literal);
     while (!variablesInfo[variableIndex].satisfiedOccur.isEmpty()) {
-        clausesInfo[variablesInfo[variableIndex].satisfiedOccur.front()].isSatisfied = false;
+        setClauseSatisfied<Width>(variablesInfo[variableIndex].satisfiedOccur.front(), false);
         variablesInfo[variableIndex].satisfiedOccur.removeFront();
         ++currentClauseNum;
     }
     while (!variablesInfo[variableIndex].deletedOccur.isEmpty()) {
-        clausesInfo[variablesInfo[variableIndex].deletedOccur.front()].literals.addBack(-literal);
+        restoreClauseLiteral<Width>(variablesInfo[variableIndex].deletedOccur.front());
         variablesInfo[variableIndex].deletedOccur.removeFront();
     }
 }
 
+template <unsigned Width>
 CNFSolver::ProcessResult CNFSolver::checkWithBacktracking(int &currentBranchingLiteral) {
-    if (currentClauseNum == 0)
+    if (currentClauseNum == 0 && !hasEmptyClause && (!isEnumerating || isModelComplete()))
         return Satisfied;
     if (hasEmptyClause) {
+        TRACE_SCOPE("CNFSolver::backtrack");
         //backtracking step, undo all the assignment made in this iteration
+        ++statistics.conflictNum;
+        unsigned proofClauseSize = proofWriter != nullptr ? logConflictClause() : 0;
         unitClauseLiteralsToAssign.clear();
         while (!assignmentsInfo.isEmpty()) {
-            while (!assignmentsInfo.front().assignedUnitClauseLiterals.isEmpty()) {
-                undoAssignment(assignmentsInfo.front().assignedUnitClauseLiterals.front());
-                assignmentsInfo.front().assignedUnitClauseLiterals.removeFront();
-            }
-            undoAssignment(assignmentsInfo.front().assignedBranchingLiteral);
-            if (!assignmentsInfo.front().isForcedAssignment) {
-                currentBranchingLiteral = -assignmentsInfo.front().assignedBranchingLiteral;
-                assignmentsInfo.removeFront();
+            ++statistics.backtrackNum;
+            int branchingLiteral = assignmentsInfo.front().assignedBranchingLiteral;
+            bool isForced = assignmentsInfo.front().isForcedAssignment;
+            undoLevel<Width>();
+            if (!isForced) {
+                currentBranchingLiteral = -branchingLiteral;
                 return BacktrackingDone;
             }
-            assignmentsInfo.removeFront();
+            if (proofWriter != nullptr) {
+                //the clause that forced this literal is subsumed by the one just logged
+                proofClause[proofClauseSize] = branchingLiteral;
+                proofWriter->deleteClause(proofClause, proofClauseSize + 1);
+            }
         }
         return Unsatisfied;
     }
     return Continued;
 }
 
-int CNFSolver::getDLCSBranchingLiteral() const {
+//undo all the assignments of the top decision level and remove it
+template <unsigned Width>
+void CNFSolver::undoLevel() {
+    while (!assignmentsInfo.front().assignedUnitClauseLiterals.isEmpty()) {
+        undoAssignment<Width>(assignmentsInfo.front().assignedUnitClauseLiterals.front());
+        assignmentsInfo.front().assignedUnitClauseLiterals.removeFront();
+    }
+    undoAssignment<Width>(assignmentsInfo.front().assignedBranchingLiteral);
+    if (xorMatrix != nullptr)
+        xorMatrix->popLevel();
+    assignmentsInfo.removeFront();
+}
+
+//the negation of all the branching literals still on the stack is implied by unit propagation,
+//because every forced literal below the conflict is justified by a clause logged earlier
+//an empty clause is logged when the conflict does not depend on any branching
+unsigned CNFSolver::logConflictClause() {
+    return logDecisionClause({});
+}
+
+//log the negation of all the branching literals still on the stack together with the given literals
+//returns the number of negated branching literals, which are left at the front of proofClause
+unsigned CNFSolver::logDecisionClause(std::initializer_list<int> literals) {
+    unsigned size = 0;
+    auto iter = assignmentsInfo.iterator();
+    while (iter.isValid()) {
+        if (!iter.element().isForcedAssignment)
+            proofClause[size++] = -iter.element().assignedBranchingLiteral;
+        iter.next();
+    }
+    unsigned decisionClauseSize = size;
+    for (int literal : literals)
+        proofClause[size++] = literal;
+    proofWriter->addClause(proofClause, size);
+    return decisionClauseSize;
+}
+
+template <unsigned Width>
+int CNFSolver::getDLCSBranchingLiteral() {
     unsigned maxCombinedSum = 0;
     int literal = 0;
     for (unsigned i = 1; i <= variableNum; ++i) {
         if (variablesInfo[i].assignedStatus == VariableInfo::None) {
             unsigned positiveSum = 0;
-            auto positiveIter = variablesInfo[i].positiveOccur.iterator();
-            while (positiveIter.isValid()) {
-                positiveSum += 1 - clausesInfo[positiveIter.element()].isSatisfied;
-                positiveIter.next();
-            }
+            for (unsigned j = occurOffsets[2 * i]; j < occurOffsets[2 * i + 1]; ++j)
+                positiveSum += 1 - isClauseSatisfied<Width>(occurClauses[j]);
             unsigned negativeSum = 0;
-            auto negativeIter = variablesInfo[i].negativeOccur.iterator();
-            while (negativeIter.isValid()) {
-                negativeSum += 1 - clausesInfo[negativeIter.element()].isSatisfied;
-                negativeIter.next();
-            }
+            for (unsigned j = occurOffsets[2 * i + 1]; j < occurOffsets[2 * i + 2]; ++j)
+                negativeSum += 1 - isClauseSatisfied<Width>(occurClauses[j]);
+            positiveSum += getOpenBinaryClauseNum(2 * i);
+            negativeSum += getOpenBinaryClauseNum(2 * i + 1);
             unsigned combinedSum = positiveSum + negativeSum;
             if (combinedSum > maxCombinedSum) {
                 maxCombinedSum = combinedSum;
@@ -443,31 +1043,32 @@ int CNFSolver::getDLCSBranchingLiteral() const {
     return literal;
 }
 
-int CNFSolver::getMOMSBranchingLiteral() const {
+//open binary clauses are the shortest clauses whenever there is one, they are counted apart from the others
+//and decide the literal unless no variable has any
+template <unsigned Width>
+int CNFSolver::getMOMSBranchingLiteral() {
     unsigned minUnsatisfiedClauseLength = originalMaxClauseLength;
     for (unsigned i = 0; i < originalClauseNum && minUnsatisfiedClauseLength != 2; ++i) {
-        if (!clausesInfo[i].isSatisfied && clausesInfo[i].literals.size() < minUnsatisfiedClauseLength)
-            minUnsatisfiedClauseLength = clausesInfo[i].literals.size();
+        if (!isClauseSatisfied<Width>(i) && getClauseLength<Width>(i) < minUnsatisfiedClauseLength)
+            minUnsatisfiedClauseLength = getClauseLength<Width>(i);
     }
     unsigned maxResult = 0;
     int literal = 0;
+    unsigned maxBinaryResult = 0;
+    int binaryLiteral = 0;
     for (unsigned i = 1; i <= variableNum; ++i) {
         if (variablesInfo[i].assignedStatus == VariableInfo::None) {
             unsigned positiveSum = 0;
-            auto positiveIter = variablesInfo[i].positiveOccur.iterator();
-            while (positiveIter.isValid()) {
-                if (!clausesInfo[positiveIter.element()].isSatisfied
-                        && clausesInfo[positiveIter.element()].literals.size() == minUnsatisfiedClauseLength)
+            for (unsigned j = occurOffsets[2 * i]; j < occurOffsets[2 * i + 1]; ++j) {
+                if (!isClauseSatisfied<Width>(occurClauses[j])
+                        && getClauseLength<Width>(occurClauses[j]) == minUnsatisfiedClauseLength)
                     ++positiveSum;
-                positiveIter.next();
             }
             unsigned negativeSum = 0;
-            auto negativeIter = variablesInfo[i].negativeOccur.iterator();
-            while (negativeIter.isValid()) {
-                if (!clausesInfo[negativeIter.element()].isSatisfied
-                        && clausesInfo[negativeIter.element()].literals.size() == minUnsatisfiedClauseLength)
+            for (unsigned j = occurOffsets[2 * i + 1]; j < occurOffsets[2 * i + 2]; ++j) {
+                if (!isClauseSatisfied<Width>(occurClauses[j])
+                        && getClauseLength<Width>(occurClauses[j]) == minUnsatisfiedClauseLength)
                     ++negativeSum;
-                negativeIter.next();
             }
             unsigned result = (positiveSum + 1) * (negativeSum + 1);
             if (result > maxResult) {
@@ -477,7 +1078,310 @@ int CNFSolver::getMOMSBranchingLiteral() const {
                 else
                     literal = -static_cast<int>(i);
             }
+
+            unsigned positiveBinarySum = getOpenBinaryClauseNum(2 * i);
+            unsigned negativeBinarySum = getOpenBinaryClauseNum(2 * i + 1);
+            if (positiveBinarySum + negativeBinarySum == 0)
+                continue;
+            if (minUnsatisfiedClauseLength == 2) {
+                positiveBinarySum += positiveSum;
+                negativeBinarySum += negativeSum;
+            }
+            unsigned binaryResult = (positiveBinarySum + 1) * (negativeBinarySum + 1);
+            if (binaryResult > maxBinaryResult) {
+                maxBinaryResult = binaryResult;
+                if (positiveBinarySum >= negativeBinarySum)
+                    binaryLiteral = static_cast<int>(i);
+                else
+                    binaryLiteral = -static_cast<int>(i);
+            }
         }
     }
-    return literal;
+    return binaryLiteral != 0 ? binaryLiteral : literal;
+}
+
+//weight of a clause shortened by a lookahead, shorter clauses constrain the rest more
+double CNFSolver::getReductionWeight(unsigned length) {
+    static const double weights[] = {0.0, 0.0, 1.0, 0.2, 0.04, 0.008};
+    return length < 6 ? weights[length] : 0.0016;
+}
+
+//rank the free variables by their weighted occurrences in both polarities and keep the best ones
+template <unsigned Width>
+unsigned CNFSolver::preselectLookaheadCandidates() {
+    unsigned freeVariableNum = 0;
+    for (unsigned i = 1; i <= variableNum; ++i) {
+        if (variablesInfo[i].assignedStatus != VariableInfo::None)
+            continue;
+        double positiveScore = getReductionWeight(2) * getOpenBinaryClauseNum(2 * i);
+        for (unsigned j = occurOffsets[2 * i]; j < occurOffsets[2 * i + 1]; ++j) {
+            if (!isClauseSatisfied<Width>(occurClauses[j]))
+                positiveScore += getReductionWeight(getClauseLength<Width>(occurClauses[j]));
+        }
+        double negativeScore = getReductionWeight(2) * getOpenBinaryClauseNum(2 * i + 1);
+        for (unsigned j = occurOffsets[2 * i + 1]; j < occurOffsets[2 * i + 2]; ++j) {
+            if (!isClauseSatisfied<Width>(occurClauses[j]))
+                negativeScore += getReductionWeight(getClauseLength<Width>(occurClauses[j]));
+        }
+        if (positiveScore + negativeScore > 0) {
+            lookaheadCandidates[freeVariableNum].variable = i;
+            lookaheadCandidates[freeVariableNum].preselectionScore = positiveScore * negativeScore + positiveScore + negativeScore;
+            ++freeVariableNum;
+        }
+    }
+
+    //about a tenth of the free variables, but never too few to find failed literals
+    unsigned candidateNum = std::min(freeVariableNum, std::max(10u, freeVariableNum / 10));
+    std::nth_element(lookaheadCandidates, lookaheadCandidates + candidateNum, lookaheadCandidates + freeVariableNum,
+                     [](const LookaheadCandidate &a, const LookaheadCandidate &b) {
+                         return a.preselectionScore > b.preselectionScore;
+                     });
+    return candidateNum;
+}
+
+//assign the literal and everything it implies by unit propagation without touching assignmentsInfo
+//the assigned literals are left in lookaheadTrail, and hasEmptyClause tells whether the literal failed
+template <unsigned Width>
+unsigned CNFSolver::propagateLookahead(int literal) {
+    unsigned trailSize = 0;
+    if (xorMatrix != nullptr)
+        xorMatrix->pushLevel();
+    unitClauseLiteralsToAssign.addBack(literal);
+    while (!unitClauseLiteralsToAssign.isEmpty() && !hasEmptyClause) {
+        int unitClauseLiteral = unitClauseLiteralsToAssign.front();
+        unitClauseLiteralsToAssign.removeFront();
+        applyAssignment<Width>(unitClauseLiteral);
+        lookaheadTrail[trailSize++] = unitClauseLiteral;
+    }
+    unitClauseLiteralsToAssign.clear();
+    return trailSize;
+}
+
+template <unsigned Width>
+void CNFSolver::undoLookahead(unsigned trailSize) {
+    while (trailSize > 0)
+        undoAssignment<Width>(lookaheadTrail[--trailSize]);
+    if (xorMatrix != nullptr)
+        xorMatrix->popLevel();
+    hasEmptyClause = false;
+}
+
+//weighted number of clauses shortened but not satisfied by the last lookahead
+template <unsigned Width>
+double CNFSolver::getLookaheadReduction(unsigned trailSize) const {
+    double reduction = 0;
+    for (unsigned i = 0; i < trailSize; ++i) {
+        auto iter = variablesInfo[std::abs(lookaheadTrail[i])].deletedOccur.iterator();
+        while (iter.isValid()) {
+            if (!isClauseSatisfied<Width>(iter.element()))
+                reduction += getReductionWeight(getClauseLength<Width>(iter.element()));
+            iter.next();
+        }
+    }
+    return reduction;
+}
+
+//a literal implied by the current assignments is added to the current level together with its implications
+template <unsigned Width>
+void CNFSolver::assignNecessaryLiteral(int literal) {
+    VariableInfo::AssignedStatus status = variablesInfo[std::abs(literal)].assignedStatus;
+    if (status != VariableInfo::None) {
+        if ((status == VariableInfo::True) != (literal > 0))
+            hasEmptyClause = true;
+        return;
+    }
+    unitClauseLiteralsToAssign.addBack(literal);
+    while (!unitClauseLiteralsToAssign.isEmpty()) {
+        int unitClauseLiteral = unitClauseLiteralsToAssign.front();
+        unitClauseLiteralsToAssign.removeFront();
+        applyAssignment<Width>(unitClauseLiteral);
+        ++statistics.propagationNum;
+        //assignments made before the first branching are never undone
+        if (!assignmentsInfo.isEmpty())
+            assignmentsInfo.front().assignedUnitClauseLiterals.addFront(unitClauseLiteral);
+        if (hasEmptyClause || currentClauseNum == 0)
+            break;
+    }
+    unitClauseLiteralsToAssign.clear();
+}
+
+//every clause is satisfied, and also the implied literals and all the projection variables have to be assigned
+//then the other variables have a completion: the free ones of the groups can be false,
+//and the XOR constraints have a solution when they have no conflict
+bool CNFSolver::isModelComplete() const {
+    if (!unitClauseLiteralsToAssign.isEmpty())
+        return false;
+    for (unsigned variable : projectionVariables) {
+        if (variablesInfo[variable].assignedStatus == VariableInfo::None)
+            return false;
+    }
+    return true;
+}
+
+//while a projection variable is free, the one with the largest combined sum is branched on,
+//so no decision above a projection variable splits the models of a projection
+template <unsigned Width>
+int CNFSolver::getProjectionBranchingLiteral() {
+    int literal = 0;
+    unsigned maxCombinedSum = 0;
+    for (unsigned variable : projectionVariables) {
+        if (variablesInfo[variable].assignedStatus != VariableInfo::None)
+            continue;
+        unsigned positiveSum = getOpenBinaryClauseNum(2 * variable);
+        unsigned negativeSum = getOpenBinaryClauseNum(2 * variable + 1);
+        for (unsigned i = occurOffsets[2 * variable]; i < occurOffsets[2 * variable + 1]; ++i)
+            positiveSum += !isClauseSatisfied<Width>(occurClauses[i]);
+        for (unsigned i = occurOffsets[2 * variable + 1]; i < occurOffsets[2 * variable + 2]; ++i)
+            negativeSum += !isClauseSatisfied<Width>(occurClauses[i]);
+        if (literal == 0 || positiveSum + negativeSum > maxCombinedSum) {
+            maxCombinedSum = positiveSum + negativeSum;
+            literal = positiveSum >= negativeSum ? static_cast<int>(variable) : -static_cast<int>(variable);
+        }
+    }
+    return literal != 0 ? literal : (this->*getBranchingLiteral)();
+}
+
+//the model is given to the callback, then the levels of the other variables are dropped, as their
+//completion does not matter, and the search backtracks as after a conflict
+//returns Satisfied when the enumeration ends here, Unsatisfied when no model is left, BacktrackingDone otherwise
+template <unsigned Width>
+CNFSolver::ProcessResult CNFSolver::processModel(int &currentBranchingLiteral) {
+    for (std::size_t i = 0; i < projectionVariables.size(); ++i) {
+        unsigned variable = projectionVariables[i];
+        int literal = static_cast<int>(originalVariables != nullptr ? originalVariables[variable] : variable);
+        modelLiterals[i] = variablesInfo[variable].assignedStatus == VariableInfo::True ? literal : -literal;
+    }
+    ++modelNum;
+    if (!modelCallback(modelLiterals.data(), static_cast<unsigned>(modelLiterals.size())) || modelNum == modelLimit)
+        return Satisfied;
+    while (!assignmentsInfo.isEmpty() && !isProjected[std::abs(assignmentsInfo.front().assignedBranchingLiteral)])
+        undoLevel<Width>();
+    hasEmptyClause = true;
+    return checkWithBacktracking<Width>(currentBranchingLiteral);
+}
+
+//the snapshot read by resume is applied in its order, so every level undoes like the one it was taken from
+//the literals assigned again by the preprocessing are skipped
+template <unsigned Width>
+void CNFSolver::replayCheckpoint() {
+    for (int literal : resumedRootLiterals) {
+        if (variablesInfo[std::abs(literal)].assignedStatus == VariableInfo::None)
+            applyAssignment<Width>(literal);
+    }
+    for (std::size_t i = 0; i < resumedLevels.size(); ) {
+        int branchingLiteral = resumedLevels[i];
+        bool isForced = resumedLevels[i + 1] != 0;
+        std::size_t end = i + 3 + static_cast<unsigned>(resumedLevels[i + 2]);
+        if (xorMatrix != nullptr)
+            xorMatrix->pushLevel();
+        applyAssignment<Width>(branchingLiteral);
+        assignmentsInfo.addFront(AssignmentInfo(branchingLiteral, isForced));
+        for (i += 3; i < end; ++i) {
+            applyAssignment<Width>(resumedLevels[i]);
+            assignmentsInfo.front().assignedUnitClauseLiterals.addFront(resumedLevels[i]);
+        }
+    }
+    if (assignmentsInfo.size() > statistics.maxDecisionDepth)
+        statistics.maxDecisionDepth = assignmentsInfo.size();
+    //the units found on the way are on the trail already
+    unitClauseLiteralsToAssign.clear();
+    hasEmptyClause = false;
+    std::vector<int>().swap(resumedRootLiterals);
+    std::vector<int>().swap(resumedLevels);
+}
+
+//look ahead on both polarities of the preselected variables:
+//a failed polarity makes the other one necessary, and so does a literal implied by both polarities
+//the variable with the largest product of reductions is returned, its less reducing polarity first
+//0 is returned with hasEmptyClause set when the necessary assignments lead to a conflict
+template <unsigned Width>
+int CNFSolver::getLookaheadBranchingLiteral() {
+    ++statistics.lookaheadNum;
+    while (true) {
+        unsigned candidateNum = preselectLookaheadCandidates<Width>();
+        if (candidateNum == 0)
+            return 0;
+        for (unsigned i = 0; i < candidateNum; ++i) {
+            LookaheadCandidate &candidate = lookaheadCandidates[i];
+            int variable = static_cast<int>(candidate.variable);
+            candidate.positiveReduction = candidate.negativeReduction = -1;
+            if (variablesInfo[variable].assignedStatus != VariableInfo::None)
+                continue;
+            ++lookaheadStamp;
+
+            unsigned trailSize = propagateLookahead<Width>(variable);
+            if (currentClauseNum == 0) {
+                undoLookahead<Width>(trailSize);
+                return variable;
+            }
+            bool isPositiveFailed = hasEmptyClause;
+            if (!isPositiveFailed) {
+                candidate.positiveReduction = getLookaheadReduction<Width>(trailSize);
+                for (unsigned j = 1; j < trailSize; ++j)
+                    lookaheadStamps[2 * std::abs(lookaheadTrail[j]) + (lookaheadTrail[j] < 0)] = lookaheadStamp;
+            }
+            undoLookahead<Width>(trailSize);
+
+            trailSize = propagateLookahead<Width>(-variable);
+            if (currentClauseNum == 0) {
+                undoLookahead<Width>(trailSize);
+                return -variable;
+            }
+            bool isNegativeFailed = hasEmptyClause;
+            unsigned necessaryLiteralNum = 0;
+            if (!isNegativeFailed) {
+                candidate.negativeReduction = getLookaheadReduction<Width>(trailSize);
+                for (unsigned j = 1; j < trailSize && !isPositiveFailed; ++j) {
+                    if (lookaheadStamps[2 * std::abs(lookaheadTrail[j]) + (lookaheadTrail[j] < 0)] == lookaheadStamp)
+                        necessaryLiterals[necessaryLiteralNum++] = lookaheadTrail[j];
+                }
+            }
+            undoLookahead<Width>(trailSize);
+
+            if (isPositiveFailed || isNegativeFailed) {
+                ++statistics.failedLiteralNum;
+                int failedLiteral = isPositiveFailed ? variable : -variable;
+                if (proofWriter != nullptr)
+                    logDecisionClause({-failedLiteral});
+                if (isPositiveFailed && isNegativeFailed) {
+                    ++statistics.failedLiteralNum;
+                    hasEmptyClause = true;
+                }
+                else
+                    assignNecessaryLiteral<Width>(-failedLiteral);
+            }
+            for (unsigned j = 0; j < necessaryLiteralNum && !hasEmptyClause && currentClauseNum != 0; ++j) {
+                //resolving the two lookahead implications gives the necessary literal
+                if (proofWriter != nullptr) {
+                    logDecisionClause({-variable, necessaryLiterals[j]});
+                    logDecisionClause({variable, necessaryLiterals[j]});
+                    logDecisionClause({necessaryLiterals[j]});
+                }
+                assignNecessaryLiteral<Width>(necessaryLiterals[j]);
+            }
+            if (hasEmptyClause || currentClauseNum == 0)
+                return 0;
+        }
+
+        double maxResult = -1;
+        int literal = 0;
+        for (unsigned i = 0; i < candidateNum; ++i) {
+            const LookaheadCandidate &candidate = lookaheadCandidates[i];
+            if (candidate.positiveReduction < 0 || candidate.negativeReduction < 0
+                    || variablesInfo[candidate.variable].assignedStatus != VariableInfo::None)
+                continue;
+            double result = 1024 * candidate.positiveReduction * candidate.negativeReduction
+                    + candidate.positiveReduction + candidate.negativeReduction;
+            if (result > maxResult) {
+                maxResult = result;
+                if (candidate.positiveReduction <= candidate.negativeReduction)
+                    literal = static_cast<int>(candidate.variable);
+                else
+                    literal = -static_cast<int>(candidate.variable);
+            }
+        }
+        //look ahead again if the necessary assignments took all the candidates
+        if (literal != 0)
+            return literal;
+    }
 }
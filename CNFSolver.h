@@ -2,17 +2,86 @@
 #define CNFSOLVER_H
 
 #include "List.h"
+#include "CNFFormula.h"
+#include "CNFInstance.h"
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
 
+class CheckpointWriter;
+class DratWriter;
+class XorMatrix;
+
+//the search state of DPLL over a CNFInstance, which may be shared with solvers on other threads
+//only the assignments, the clause counters and the undo stacks belong to the solver
 class CNFSolver {
 
 public:
 
-    explicit CNFSolver(std::istream &, bool);
+    //counters collected during the search, times are in nanoseconds
+    struct Statistics {
+        unsigned long long decisionNum;
+        unsigned long long propagationNum;
+        unsigned long long conflictNum;
+        unsigned long long backtrackNum; //number of undone decision levels
+        unsigned long long lookaheadNum;
+        unsigned long long failedLiteralNum; //literals found false by lookahead
+        unsigned maxDecisionDepth;
+        unsigned long long preprocessTime;
+        unsigned long long propagationTime;
+        unsigned long long branchingTime;
+        unsigned long long solveTime;
+
+        Statistics()
+            : decisionNum(0), propagationNum(0), conflictNum(0), backtrackNum(0),
+              lookaheadNum(0), failedLiteralNum(0), maxDecisionDepth(0),
+              preprocessTime(0), propagationTime(0), branchingTime(0), solveTime(0) {}
+    };
+
+    enum BranchingRule {
+        DLCS, //Dynamic Largest Combined Sum
+        MOMS, //Maximum Occurrences on clauses of Minimum Size
+        Lookahead, //march-style lookahead on preselected variables
+        Auto //one of the above chosen by CNFFeatures from the formula
+    };
+
+    //callback invoked from the solving thread, at most once per interval
+    using ProgressCallback = std::function<void(const Statistics &)>;
+
+    //callback invoked with the projected literals of every model found, returns false to stop the enumeration
+    using ModelCallback = std::function<bool(const int *, unsigned)>;
+
+    explicit CNFSolver(std::istream &, BranchingRule);
+    explicit CNFSolver(const CNFFormula &, BranchingRule);
+    explicit CNFSolver(std::shared_ptr<const CNFInstance>, BranchingRule);
     explicit CNFSolver(unsigned [][10]);
     ~CNFSolver();
     bool isSatisfied(); //DPLL based algorithm
-    void printSatisfiabilityInfo(std::ostream &);
+    bool printSatisfiabilityInfo(std::ostream &);
+    bool printSatisfiabilityInfo(std::ostream &, std::ostream &); //the model line goes to the second stream
+    //every model once, projected onto the given variables or all of them when none is given,
+    //the search backtracks past each model instead of starting again and no model is kept
+    //returns the number of models given to the callback, at most modelLimit unless it is 0
+    //call it instead of isSatisfied, no proof or snapshot is written while enumerating
+    unsigned long long enumerateModels(const std::vector<unsigned> &, unsigned long long modelLimit, ModelCallback);
+    unsigned long long printModels(std::ostream &, std::ostream &, const std::vector<unsigned> &, unsigned long long); //v lines to the second stream
+    bool isEnumerationComplete() const; //no model was left out by the limit, the callback or a stop
+    void printModel(std::ostream &) const;
+    void printStatistics(std::ostream &) const;
+    const Statistics &getStatistics() const;
+    void setProgressCallback(ProgressCallback, unsigned intervalMilliseconds = 200);
+    void setProofWriter(DratWriter *); //log a DRAT proof of unsatisfiability, call it before solving
+    void setStopFlag(const std::atomic<bool> *); //the search gives up at the next decision once the flag is set
+    bool isStopped() const; //isSatisfied returned false because the search gave up
+    unsigned getXorNum() const; //XOR constraints given or detected
+    unsigned getGroupNum() const; //at-most-one groups propagated natively
+    bool canLogProof() const; //no proof is logged for XOR constraints, at-most-one groups and resumed searches
+    void setCheckpointWriter(CheckpointWriter *, unsigned intervalSeconds = 60); //snapshots, and a last one when stopped
+    bool resume(std::istream &); //continue the search from a snapshot, false if it is not one of this formula
     static bool solveSudoku(unsigned [][10]);
 
     //disable all the unused functions
@@ -23,11 +92,19 @@ public:
 
 private:
 
-    struct ClauseInfo {
+    //the literals of a clause are read from the instance, only the number of unassigned ones is kept
+    struct ClauseState {
+        unsigned activeLiteralNum;
         bool isSatisfied;
-        List<int> literals;
+    };
 
-        ClauseInfo() : isSatisfied(false) {}
+    //the unassigned literals of a clause of at most Width literals stored inline with its state
+    //the literals are never moved, unused slots repeat the last literal
+    template <unsigned Width>
+    struct alignas(16) PackedClause {
+        int literals[Width];
+        unsigned char activeLiteralNum;
+        bool isSatisfied;
     };
 
     struct VariableInfo {
@@ -39,8 +116,6 @@ private:
         };
 
         AssignedStatus assignedStatus;
-        List<unsigned> positiveOccur;
-        List<unsigned> negativeOccur;
 
         //stacks that store information about changes after an assignment
         List<unsigned> satisfiedOccur;
@@ -49,6 +124,14 @@ private:
         VariableInfo() : assignedStatus(None) {}
     };
 
+    //a preselected variable and the reductions found by looking ahead on both polarities
+    struct LookaheadCandidate {
+        unsigned variable;
+        double preselectionScore;
+        double positiveReduction;
+        double negativeReduction;
+    };
+
     enum ProcessResult {
         Unsatisfied,
         Satisfied,
@@ -71,15 +154,52 @@ private:
             : assignedBranchingLiteral(branchingLiteral), isForcedAssignment(isForced) {}
     };
 
-    unsigned originalClauseNum;
-    unsigned currentClauseNum;
-    ClauseInfo *clausesInfo; //array size decided by originalClauseNum
+    std::shared_ptr<const CNFInstance> instance;
+
+    unsigned originalClauseNum; //clauses with occurrences, the binary clauses of the instance are left out
+    unsigned currentClauseNum; //unsatisfied clauses, binary ones included
+    ClauseState *clauseStates; //array size decided by originalClauseNum
+
+    //packed copies of clauseStates used instead of it by the search when all the clauses left are short enough
+    PackedClause<2> *twoLiteralClauses; //array size decided by originalClauseNum
+    PackedClause<3> *threeLiteralClauses; //array size decided by originalClauseNum
+
+    //occurrence lists of the instance, indexed by 2 * variable + (literal < 0)
+    const unsigned *occurOffsets;
+    const unsigned *occurClauses;
+
+    //binary clauses of the instance as implications, indexed like the occurrences, both nullptr for none
+    const unsigned *implicationOffsets;
+    const int *implicationLiterals;
+    unsigned *truePartnerNums; //true other literals of the binary clauses of a literal, array size decided by 2 * variableNum + 2
 
     unsigned variableNum;
     VariableInfo *variablesInfo; //array size decided by variableNum
 
+    //numbers of a renumbered formula, both nullptr unless renumbered
+    //models, projections and proofs use the numbers of the file
+    const unsigned *originalVariables;
+    const unsigned *renumberedVariables;
+
+    //at-most-one groups of variables of the instance, once a variable is true all the others of its groups are made false
+    unsigned groupNum;
+    const unsigned *groupOffsets;
+    const unsigned *groupVariables; //group i is groupVariables[groupOffsets[i]] to groupVariables[groupOffsets[i + 1] - 1]
+    unsigned *groupTrueNums; //number of true variables in each group, array size decided by groupNum
+    const unsigned *variableGroupOffsets;
+    const unsigned *variableGroups;
+
+    BranchingRule branchingRule;
+
     //function pointer to apply branching rule selected by user
-    int (CNFSolver::*getBranchingLiteral)() const;
+    int (CNFSolver::*getBranchingLiteral)();
+
+    //buffers of the lookahead branching rule, only allocated when it is selected
+    LookaheadCandidate *lookaheadCandidates; //array size decided by variableNum
+    int *lookaheadTrail; //literals assigned by a lookahead, size decided by variableNum
+    int *necessaryLiterals; //literals implied by both polarities, size decided by variableNum
+    unsigned *lookaheadStamps; //array size decided by 2 * variableNum + 2, indexed like occurOffsets
+    unsigned lookaheadStamp;
 
     unsigned originalMaxClauseLength;
     bool hasEmptyClause;
@@ -90,12 +210,86 @@ private:
     //stack that stores all current assignment information
     List<AssignmentInfo> assignmentsInfo;
 
+    Statistics statistics;
+    ProgressCallback progressCallback;
+    const std::atomic<bool> *stopFlag;
+    bool hasStopped;
+    std::chrono::steady_clock::duration progressInterval;
+    std::chrono::steady_clock::time_point lastProgressTime;
+
+    //periodic snapshots of the search, see writeCheckpoint for the format
+    CheckpointWriter *checkpointWriter;
+    std::chrono::steady_clock::duration checkpointInterval;
+    std::chrono::steady_clock::time_point lastCheckpointTime;
+    std::vector<char> checkpointBuffer;
+
+    //the search state read by resume, replayed before the first decision
+    bool isResumed;
+    std::vector<int> resumedRootLiterals; //assignments never undone
+    std::vector<int> resumedLevels; //branching literal, forced flag, unit literal number, unit literals, from the bottom
+
+    //model enumeration: the projection variables are branched on first, and once they are all assigned
+    //the other variables only have to be completed, so a model is found once for each projection
+    bool isEnumerating;
+    std::vector<unsigned> projectionVariables;
+    std::vector<bool> isProjected; //indexed by variable
+    std::vector<int> modelLiterals; //buffer for the callback
+    ModelCallback modelCallback;
+    unsigned long long modelLimit;
+    unsigned long long modelNum;
+    bool isEnumerationExhausted; //the search ran out of models
+
+    //copy of the XOR constraints of the instance, nullptr when there is none
+    XorMatrix *xorMatrix;
+
+    DratWriter *proofWriter;
+    int *proofClause; //buffer for the clause being logged, size decided by variableNum + 1
+
+    bool search();
     ProcessResult preprocess();
-    void applyAssignment(int);
-    void undoAssignment(int);
-    ProcessResult checkWithBacktracking(int &);
-    int getDLCSBranchingLiteral() const;
-    int getMOMSBranchingLiteral() const;
+    unsigned logConflictClause();
+    unsigned logDecisionClause(std::initializer_list<int>);
+    static double getReductionWeight(unsigned);
+    void assignXorModel();
+    void applyGroupAssignment(unsigned);
+    void undoGroupAssignment(unsigned);
+    void assignGroupModel();
+    void writeCheckpoint(bool isLast);
+    bool isModelComplete() const;
+
+    bool isLiteralTrue(int) const;
+    void applyBinaryClauses(int);
+    void undoBinaryClauses(int);
+    unsigned getOpenBinaryClauseNum(unsigned) const;
+
+    //the kernels below take the packed clause width, 0 selects the general clauseStates
+    template <unsigned Width> PackedClause<Width> *getPackedClauses() const;
+    template <unsigned Width> PackedClause<Width> *packClauses() const;
+    template <unsigned Width> bool isClauseSatisfied(unsigned) const;
+    template <unsigned Width> void setClauseSatisfied(unsigned, bool);
+    template <unsigned Width> unsigned getClauseLength(unsigned) const; //active literals
+    template <unsigned Width> int getClauseFront(unsigned) const; //the active literal of a unit clause
+    template <unsigned Width> void removeClauseLiteral(unsigned);
+    template <unsigned Width> void restoreClauseLiteral(unsigned);
+    template <unsigned Width> bool branchAndPropagate();
+    template <unsigned Width> void applyAssignment(int);
+    template <unsigned Width> void undoAssignment(int);
+    template <unsigned Width> ProcessResult checkWithBacktracking(int &);
+    template <unsigned Width> int getDLCSBranchingLiteral();
+    template <unsigned Width> int getMOMSBranchingLiteral();
+    template <unsigned Width> int getLookaheadBranchingLiteral();
+    template <unsigned Width> unsigned preselectLookaheadCandidates();
+    template <unsigned Width> unsigned propagateLookahead(int);
+    template <unsigned Width> void undoLookahead(unsigned);
+    template <unsigned Width> double getLookaheadReduction(unsigned) const;
+    template <unsigned Width> void assignNecessaryLiteral(int);
+    template <unsigned Width> void replayCheckpoint();
+    template <unsigned Width> void undoLevel();
+    template <unsigned Width> int getProjectionBranchingLiteral();
+    template <unsigned Width> ProcessResult processModel(int &);
+
+    //the microbenchmark suite times the kernels above directly
+    friend class CNFSolverBenchmark;
 };
 
 #endif // CNFSOLVER_H
@@ -0,0 +1,240 @@
+#include "CNFSolverJob.h"
+#include "CNFFeatures.h"
+#include "CNFResultCache.h"
+#include "CheckpointWriter.h"
+#include "DratWriter.h"
+#include "LocalSearchSolver.h"
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <memory>
+#include <QTextCodec>
+#include <QFileInfo>
+
+CNFSolverJob::CNFSolverJob(const std::string &fileName, const Options &options, QObject *parent)
+    : QObject(parent),
+      fileName(fileName),
+      options(options) {}
+
+CNFSolverJob::Result CNFSolverJob::solve(const std::string &fileName, const Options &options,
+                                               const CNFSolver::ProgressCallback &progressCallback,
+                                               const std::atomic<bool> *cancelFlag) {
+    std::stringstream output;
+    QTextCodec *code = QTextCodec::codecForLocale();
+    QString fileNameString = code->toUnicode(fileName.c_str());
+    Result result;
+    if (cancelFlag != nullptr && cancelFlag->load()) {
+        output << fileNameString.toStdString() << " canceled." << std::endl;
+        result.text = QString::fromStdString(output.str());
+        result.isDecided = false;
+        result.isSatisfied = false;
+        return result;
+    }
+    output << fileNameString.toStdString() << " solved!" << std::endl;
+    std::string modelFileName = fileName + ".model";
+
+    //a proof or a checkpoint is asked of the search itself, so those solves neither use nor fill the cache
+    //the cached text starts after the line naming the file, and no later line names one
+    CNFResultCache &resultCache = CNFResultCache::getInstance();
+    CNFResultCache::Key cacheKey;
+    bool usesResultCache = options.usesResultCache && !options.writesProof && !options.writesCheckpoint
+            && resultCache.isEnabled() && CNFResultCache::makeKey(fileName, getOptionTag(options), cacheKey);
+    std::streamoff cachedTextBegin = output.tellp();
+    CNFResultCache::Entry cacheEntry;
+    if (usesResultCache && resultCache.find(cacheKey, cacheEntry)) {
+        output << "Found in the result cache, the same file was solved with the same options before." << std::endl;
+        output << cacheEntry.text;
+        result.isDecided = true;
+        result.isSatisfied = cacheEntry.isSatisfied;
+        result.statistics = cacheEntry.statistics;
+        if (options.writesModelToFile) {
+            std::ofstream modelFile(modelFileName, std::ios::binary);
+            modelFile << cacheEntry.modelText;
+        }
+        if (result.isSatisfied && options.writesModelToFile)
+            output << (options.modelLimit > 0 ? "Models written to " : "Model written to ")
+                   << code->toUnicode(modelFileName.c_str()).toStdString() << std::endl;
+        result.text = QString::fromStdString(output.str());
+        return result;
+    }
+
+    std::ifstream input(fileName);
+    CNFFormula formula(input);
+
+    //large models skip the result text and the GUI entirely
+    std::ofstream modelFile;
+    if (options.writesModelToFile)
+        modelFile.open(modelFileName, std::ios::binary);
+    std::ostream &modelOutput = options.writesModelToFile ? static_cast<std::ostream &>(modelFile) : output;
+
+    //the Auto rule also picks local search and renumbering from the features of the formula
+    Options::Engine engine = options.engine;
+    CNFSolver::BranchingRule branchingRule = options.selectedBranchingRule;
+    bool renumbersVariables = options.renumbersVariables;
+    if (branchingRule == CNFSolver::Auto) {
+        CNFFeatures features(formula);
+        CNFFeatures::Configuration configuration = features.getConfiguration();
+        output << "Chose the configuration from the features of the formula." << std::endl;
+        features.print(output);
+        branchingRule = configuration.branchingRule;
+        if (configuration.triesLocalSearch && engine == Options::Complete)
+            engine = Options::LocalSearchFirst;
+        renumbersVariables = renumbersVariables || configuration.renumbersVariables;
+    }
+
+    result.isDecided = false;
+    result.isSatisfied = false;
+    unsigned long long localSearchTime = 0;
+    //local search only sees the clauses, the XOR constraints and at-most-one groups would be ignored
+    if (engine != Options::Complete && (formula.getXorNum() > 0 || formula.getGroupNum() > 0))
+        output << "Local search skipped, it does not support XOR constraints or at-most-one groups." << std::endl;
+    else if (engine != Options::Complete && options.modelLimit > 0)
+        output << "Local search skipped, it cannot enumerate models." << std::endl;
+    else if (engine != Options::Complete) {
+        output << "Used ProbSAT local search with a budget of " << options.flipBudget << " flips." << std::endl;
+        LocalSearchSolver localSearch(formula);
+        result.isSatisfied = localSearch.printSatisfiabilityInfo(options.flipBudget, output, modelOutput);
+        localSearchTime = localSearch.getStatistics().solveTime;
+        result.isDecided = result.isSatisfied;
+    }
+
+    if (!result.isDecided && engine == Options::LocalSearch && options.modelLimit == 0)
+        output << "s UNKNOWN" << std::endl;
+    else if (!result.isDecided) {
+        switch (branchingRule) {
+        case CNFSolver::DLCS:
+            output << "Used DLCS(Dynamic Largest Combined Sum) branching rule." << std::endl;
+            break;
+        case CNFSolver::MOMS:
+            output << "Used MOMS(Maximum Occurrences on clauses of Minimum Size) branching rule." << std::endl;
+            break;
+        case CNFSolver::Lookahead:
+            output << "Used lookahead branching rule with failed literal detection." << std::endl;
+            break;
+        case CNFSolver::Auto:
+            break;
+        }
+        if (renumbersVariables) {
+            using namespace std::chrono;
+            double clauseSpan = formula.getClauseSpan();
+            steady_clock::time_point start = steady_clock::now();
+            formula.renumber();
+            output << "Renumbered variables and clauses in "
+                   << duration_cast<milliseconds>(steady_clock::now() - start).count()
+                   << "ms, average clause span " << clauseSpan << " -> " << formula.getClauseSpan() << '.' << std::endl;
+        }
+        //XOR constraints detected in the clauses would leave no DRAT proof, so a requested proof keeps the clauses as they are
+        CNFSolver solver(std::make_shared<const CNFInstance>(formula, !options.writesProof), branchingRule);
+        solver.setStopFlag(cancelFlag);
+        if (solver.getXorNum() > 0)
+            output << "Used Gauss-Jordan elimination on " << solver.getXorNum() << " XOR constraints." << std::endl;
+        if (solver.getGroupNum() > 0)
+            output << "Propagated " << solver.getGroupNum() << " at-most-one groups natively." << std::endl;
+        if (progressCallback)
+            solver.setProgressCallback(progressCallback);
+        std::string checkpointFileName = fileName + ".checkpoint";
+        QString checkpointFileNameString = code->toUnicode(checkpointFileName.c_str());
+        std::unique_ptr<CheckpointWriter> checkpointWriter;
+        if (options.writesCheckpoint && options.modelLimit > 0)
+            output << "No checkpoint is written while enumerating models." << std::endl;
+        else if (options.writesCheckpoint) {
+            std::ifstream checkpointFile(checkpointFileName, std::ios::binary);
+            if (checkpointFile && solver.resume(checkpointFile))
+                output << "Resumed from " << checkpointFileNameString.toStdString() << " after "
+                       << solver.getStatistics().decisionNum << " decisions." << std::endl;
+            else if (checkpointFile)
+                output << "Ignored " << checkpointFileNameString.toStdString() << ", it is not a snapshot of this formula." << std::endl;
+            checkpointFile.close();
+            checkpointWriter.reset(new CheckpointWriter(checkpointFileName));
+            solver.setCheckpointWriter(checkpointWriter.get());
+        }
+        std::string proofFileName = fileName + ".drat";
+        std::unique_ptr<DratWriter> proofWriter;
+        if (options.writesProof && !solver.canLogProof())
+            output << "No DRAT proof is written for XOR constraints, at-most-one groups or a resumed search." << std::endl;
+        else if (options.writesProof) {
+            proofWriter.reset(new DratWriter(proofFileName));
+            solver.setProofWriter(proofWriter.get());
+        }
+        if (options.modelLimit > 0) {
+            const std::vector<unsigned> &projection = formula.getProjection();
+            output << "Enumerated at most " << options.modelLimit << " models";
+            if (!projection.empty())
+                output << " projected onto " << projection.size() << " variables";
+            output << "." << std::endl;
+            result.isSatisfied = solver.printModels(output, modelOutput, projection, options.modelLimit) > 0;
+        }
+        else
+            result.isSatisfied = solver.printSatisfiabilityInfo(output, modelOutput);
+        result.isDecided = !solver.isStopped();
+        if (solver.isStopped())
+            output << "Canceled before the search was done." << std::endl;
+        result.statistics = solver.getStatistics();
+        if (checkpointWriter) {
+            checkpointWriter->flush();
+            bool hasFailed = checkpointWriter->hasFailed();
+            checkpointWriter.reset();
+            //a finished search has nothing to resume
+            if (!solver.isStopped())
+                std::remove(checkpointFileName.c_str());
+            else if (hasFailed)
+                output << "Cannot write the search state to " << checkpointFileNameString.toStdString() << std::endl;
+            else
+                output << "Search state saved to " << checkpointFileNameString.toStdString() << " to resume later." << std::endl;
+        }
+        if (proofWriter) {
+            bool isProofWritten = proofWriter->isOpen();
+            proofWriter.reset(); //flush before reporting
+            if (solver.isStopped())
+                output << "The DRAT proof in " << code->toUnicode(proofFileName.c_str()).toStdString() << " is incomplete." << std::endl;
+            else if (isProofWritten)
+                output << "Binary DRAT proof written to " << code->toUnicode(proofFileName.c_str()).toStdString() << std::endl;
+            else
+                output << "Cannot open " << code->toUnicode(proofFileName.c_str()).toStdString() << " for the DRAT proof." << std::endl;
+        }
+    }
+    result.statistics.solveTime += localSearchTime;
+    if (usesResultCache && result.isDecided) {
+        cacheEntry.isSatisfied = result.isSatisfied;
+        cacheEntry.statistics = result.statistics;
+        cacheEntry.text = output.str().substr(static_cast<std::size_t>(cachedTextBegin));
+        //the model file is read back, unless it is too large to be cached anyway
+        bool isModelKept = !options.writesModelToFile
+                || static_cast<unsigned long long>(modelFile.tellp()) <= resultCache.getCapacity();
+        if (options.writesModelToFile && isModelKept) {
+            modelFile.close();
+            std::ifstream writtenModelFile(modelFileName, std::ios::binary);
+            cacheEntry.modelText.assign(std::istreambuf_iterator<char>(writtenModelFile), std::istreambuf_iterator<char>());
+        }
+        if (isModelKept)
+            resultCache.store(cacheKey, cacheEntry);
+    }
+    if (result.isSatisfied && options.writesModelToFile)
+        output << (options.modelLimit > 0 ? "Models written to " : "Model written to ")
+               << code->toUnicode(modelFileName.c_str()).toStdString() << std::endl;
+    result.text = QString::fromStdString(output.str());
+    return result;
+}
+
+//every option that changes the text, the model or the statistics of a decided result
+std::string CNFSolverJob::getOptionTag(const Options &options) {
+    std::ostringstream tag;
+    tag << "engine " << options.engine << " flips " << options.flipBudget << " rule " << options.selectedBranchingRule
+        << " models " << options.modelLimit << " renumber " << options.renumbersVariables
+        << " modelfile " << options.writesModelToFile;
+    return tag.str();
+}
+
+void CNFSolverJob::run(const JobScheduler::Job &job) {
+    QString baseName = QFileInfo(QTextCodec::codecForLocale()->toUnicode(fileName.c_str())).fileName();
+    auto progressCallback = [this, &baseName](const CNFSolver::Statistics &statistics) {
+        emit sendProgress(QString("%1: %2 decisions, %3 conflicts, depth %4")
+                          .arg(baseName)
+                          .arg(statistics.decisionNum)
+                          .arg(statistics.conflictNum)
+                          .arg(statistics.maxDecisionDepth));
+    };
+    emit sendResult(solve(fileName, options, progressCallback, &job.getCancelFlag()).text);
+}
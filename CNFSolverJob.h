@@ -0,0 +1,67 @@
+#ifndef CNFSOLVERJOB_H
+#define CNFSOLVERJOB_H
+
+#include "CNFSolver.h"
+#include "JobScheduler.h"
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <string>
+
+//solving of a single CNF file, run as a job of the scheduler
+class CNFSolverJob : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+
+        enum Engine {
+            Complete, //DPLL
+            LocalSearch, //ProbSAT only, may give up
+            LocalSearchFirst //ProbSAT within the flip budget, then DPLL
+        };
+
+        Engine engine;
+        unsigned long long flipBudget;
+        CNFSolver::BranchingRule selectedBranchingRule;
+        bool writesProof; //binary DRAT proof to <file>.drat
+        bool writesModelToFile; //model line to <file>.model instead of the result text
+        bool writesCheckpoint; //search snapshots to <file>.checkpoint, and resume from it when it is there
+        unsigned long long modelLimit; //0 to decide satisfiability, otherwise models to enumerate with DPLL
+        bool renumbersVariables; //DPLL on a cache friendly numbering, results still use the numbers of the file
+        bool usesResultCache; //a file solved before with the same options is answered by the result cache
+
+        Options()
+            : engine(Complete), flipBudget(10000000), selectedBranchingRule(CNFSolver::DLCS),
+              writesProof(false), writesModelToFile(false), writesCheckpoint(false), modelLimit(0),
+              renumbersVariables(false), usesResultCache(false) {}
+    };
+
+    struct Result {
+        QString text;
+        bool isDecided; //false when only local search was run and it gave up, or the job was canceled
+        bool isSatisfied;
+        CNFSolver::Statistics statistics; //solveTime includes the local search
+    };
+
+    CNFSolverJob(const std::string &, const Options &, QObject *parent = nullptr);
+
+    //solve a CNF file in the calling thread, also used by the batch solving tasks
+    //the search gives up once the cancel flag is set
+    static Result solve(const std::string &, const Options &, const CNFSolver::ProgressCallback &,
+                        const std::atomic<bool> *cancelFlag = nullptr);
+
+    void run(const JobScheduler::Job &);
+
+signals:
+    void sendResult(QString);
+    void sendProgress(QString);
+
+private:
+    std::string fileName;
+    Options options;
+
+    static std::string getOptionTag(const Options &); //the options a cached result depends on
+};
+
+#endif // CNFSOLVERJOB_H
@@ -0,0 +1,14 @@
+#include "CNFSolverTask.h"
+#include <QTextCodec>
+
+CNFSolverTask::CNFSolverTask(const QString &fileName, const CNFSolverJob::Options &options, QObject *parent)
+    : QObject(parent),
+      fileName(fileName),
+      options(options) {}
+
+void CNFSolverTask::run(const JobScheduler::Job &job) {
+    std::string stdFileName = QTextCodec::codecForLocale()->fromUnicode(fileName).data();
+    CNFSolverJob::Result result = CNFSolverJob::solve(stdFileName, options, nullptr, &job.getCancelFlag());
+    QString status = job.isCanceled() && !result.isDecided ? "CANCELED" : !result.isDecided ? "UNKNOWN" : result.isSatisfied ? "SAT" : "UNSAT";
+    emit sendResult(fileName, status, result.statistics.solveTime / 1000000.0, result.statistics.decisionNum);
+}
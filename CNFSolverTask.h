@@ -0,0 +1,27 @@
+#ifndef CNFSOLVERTASK_H
+#define CNFSOLVERTASK_H
+
+#include "CNFSolverJob.h"
+#include "JobScheduler.h"
+#include <QObject>
+#include <QString>
+
+//one file of a batch, run as a low priority job of the scheduler
+class CNFSolverTask : public QObject {
+    Q_OBJECT
+
+public:
+    CNFSolverTask(const QString &, const CNFSolverJob::Options &, QObject *parent = nullptr);
+
+    void run(const JobScheduler::Job &);
+
+signals:
+    //file name, result as SAT, UNSAT, UNKNOWN or CANCELED, solving time in milliseconds, decisions
+    void sendResult(QString, QString, double, qulonglong);
+
+private:
+    QString fileName;
+    CNFSolverJob::Options options;
+};
+
+#endif // CNFSOLVERTASK_H
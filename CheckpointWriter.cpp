@@ -0,0 +1,87 @@
+#include "CheckpointWriter.h"
+#include <cstdio>
+#include <fstream>
+
+CheckpointWriter::CheckpointWriter(const std::string &fileName)
+    : fileName(fileName),
+      isPending(false),
+      isClosing(false),
+      writtenNum(0),
+      isFailed(false) {
+    writer = std::thread(&CheckpointWriter::writeSnapshots, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isClosing = true;
+    }
+    condition.notify_all();
+    writer.join();
+}
+
+bool CheckpointWriter::isBusy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return isPending;
+}
+
+bool CheckpointWriter::write(std::vector<char> &buffer, bool waits) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (isPending && !waits)
+        return false;
+    condition.wait(lock, [this] { return !isPending; });
+    pendingBuffer.swap(buffer);
+    isPending = true;
+    lock.unlock();
+    condition.notify_all();
+    return true;
+}
+
+void CheckpointWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] { return !isPending; });
+}
+
+unsigned long long CheckpointWriter::getWrittenNum() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writtenNum;
+}
+
+bool CheckpointWriter::hasFailed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return isFailed;
+}
+
+bool CheckpointWriter::writeFile(const std::vector<char> &buffer) const {
+    std::string temporaryFileName = fileName + ".tmp";
+    {
+        std::ofstream file(temporaryFileName, std::ios::binary | std::ios::trunc);
+        if (!file.write(buffer.data(), static_cast<std::streamsize>(buffer.size())) || !file.flush())
+            return false;
+    }
+    //rename does not replace an existing file everywhere
+    if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0) {
+        std::remove(fileName.c_str());
+        return std::rename(temporaryFileName.c_str(), fileName.c_str()) == 0;
+    }
+    return true;
+}
+
+//the snapshot pending when closing is still written
+void CheckpointWriter::writeSnapshots() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return isPending || isClosing; });
+        if (!isPending)
+            return;
+        lock.unlock();
+        bool isWritten = writeFile(pendingBuffer);
+        lock.lock();
+        if (isWritten)
+            ++writtenNum;
+        else
+            isFailed = true;
+        isPending = false;
+        condition.notify_all();
+    }
+}
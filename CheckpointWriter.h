@@ -0,0 +1,55 @@
+#ifndef CHECKPOINTWRITER_H
+#define CHECKPOINTWRITER_H
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+//snapshots of a long search written to a file by a background thread
+//the solver fills one buffer while the thread writes the other one, and a snapshot taken
+//before the previous one is written is dropped unless it is the last one, so the search never waits
+//every snapshot goes to a temporary file that then replaces the checkpoint,
+//so a crash while writing leaves the previous snapshot intact
+class CheckpointWriter {
+
+public:
+
+    explicit CheckpointWriter(const std::string &);
+    ~CheckpointWriter(); //wait for the snapshot being written
+    const std::string &getFileName() const;
+    bool isBusy(); //the previous snapshot is still being written
+    bool write(std::vector<char> &, bool waits = false); //swaps the buffer with the idle one, false when dropped
+    void flush(); //wait until the last snapshot is in the file
+    unsigned long long getWrittenNum(); //snapshots in the file so far
+    bool hasFailed(); //a snapshot could not be written
+
+    //disable all the unused functions
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    CheckpointWriter(CheckpointWriter &&) = delete;
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+    CheckpointWriter &operator=(CheckpointWriter &&) = delete;
+
+private:
+
+    std::string fileName;
+    std::vector<char> pendingBuffer; //owned by the writer thread while isPending
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool isPending;
+    bool isClosing;
+    unsigned long long writtenNum;
+    bool isFailed;
+
+    bool writeFile(const std::vector<char> &) const;
+    void writeSnapshots();
+};
+
+inline const std::string &CheckpointWriter::getFileName() const {
+    return fileName;
+}
+
+#endif // CHECKPOINTWRITER_H
@@ -0,0 +1,111 @@
+#include "DratWriter.h"
+#include <cstdlib>
+
+DratWriter::DratWriter(const std::string &fileName, bool isBinary)
+    : file(fileName, std::ios::binary),
+      isBinary(isBinary),
+      variableMap(nullptr),
+      buffers{new char[bufferCapacity], new char[bufferCapacity]},
+      currentBuffer(0),
+      position(0),
+      pendingSize(0),
+      isClosing(false) {
+    writer = std::thread(&DratWriter::writeBuffers, this);
+}
+
+DratWriter::~DratWriter() {
+    swapBuffers();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isClosing = true;
+    }
+    condition.notify_all();
+    writer.join();
+    file.flush();
+    delete[] buffers[0];
+    delete[] buffers[1];
+}
+
+bool DratWriter::isOpen() const {
+    return file.is_open();
+}
+
+void DratWriter::addClause(const int *literals, unsigned size) {
+    writeLine('a', literals, size);
+}
+
+void DratWriter::deleteClause(const int *literals, unsigned size) {
+    writeLine('d', literals, size);
+}
+
+void DratWriter::setVariableMap(const unsigned *map) {
+    variableMap = map;
+}
+
+void DratWriter::writeLine(char type, const int *literals, unsigned size) {
+    if (isBinary) {
+        //'a' or 'd', then every literal as a variable-length 2 * variable + sign, then a zero byte
+        putByte(type);
+        for (unsigned i = 0; i < size; ++i) {
+            unsigned variable = static_cast<unsigned>(std::abs(literals[i]));
+            unsigned value = 2 * (variableMap != nullptr ? variableMap[variable] : variable) + (literals[i] < 0);
+            while (value > 127) {
+                putByte(static_cast<char>(128 | (value & 127)));
+                value >>= 7;
+            }
+            putByte(static_cast<char>(value));
+        }
+        putByte(0);
+    }
+    else {
+        if (type == 'd') {
+            putByte('d');
+            putByte(' ');
+        }
+        for (unsigned i = 0; i < size; ++i) {
+            char digits[12];
+            int digitNum = 0;
+            unsigned value = static_cast<unsigned>(std::abs(literals[i]));
+            if (variableMap != nullptr)
+                value = variableMap[value];
+            do {
+                digits[digitNum++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            if (literals[i] < 0)
+                putByte('-');
+            while (digitNum > 0)
+                putByte(digits[--digitNum]);
+            putByte(' ');
+        }
+        putByte('0');
+        putByte('\n');
+    }
+}
+
+void DratWriter::swapBuffers() {
+    std::unique_lock<std::mutex> lock(mutex);
+    //wait until the writer thread is done with the other buffer
+    condition.wait(lock, [this] { return pendingSize == 0; });
+    pendingSize = position;
+    currentBuffer ^= 1;
+    position = 0;
+    lock.unlock();
+    condition.notify_all();
+}
+
+void DratWriter::writeBuffers() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return pendingSize != 0 || isClosing; });
+        if (pendingSize == 0)
+            return;
+        const char *data = buffers[currentBuffer ^ 1];
+        std::size_t size = pendingSize;
+        lock.unlock();
+        file.write(data, static_cast<std::streamsize>(size));
+        lock.lock();
+        pendingSize = 0;
+        condition.notify_all();
+    }
+}
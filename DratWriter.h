@@ -0,0 +1,62 @@
+#ifndef DRATWRITER_H
+#define DRATWRITER_H
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+//DRAT proof output in binary or text format
+//lines are appended to a large buffer, full buffers are written by a background thread
+//while the solver keeps filling the other one
+class DratWriter {
+
+public:
+
+    explicit DratWriter(const std::string &, bool isBinary = true);
+    ~DratWriter(); //flush and close
+    bool isOpen() const;
+    void addClause(const int *, unsigned);
+    void deleteClause(const int *, unsigned);
+    void setVariableMap(const unsigned *); //variables are written as map[variable], nullptr for none
+
+    //disable all the unused functions
+    DratWriter(const DratWriter &) = delete;
+    DratWriter(DratWriter &&) = delete;
+    DratWriter &operator=(const DratWriter &) = delete;
+    DratWriter &operator=(DratWriter &&) = delete;
+
+private:
+
+    static const std::size_t bufferCapacity = 1 << 22;
+
+    std::ofstream file;
+    bool isBinary;
+    const unsigned *variableMap;
+
+    //double buffering: the solver fills buffers[currentBuffer], the writer thread owns the other one
+    char *buffers[2];
+    unsigned currentBuffer;
+    std::size_t position;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::size_t pendingSize; //bytes of the other buffer still to be written, 0 if none
+    bool isClosing;
+
+    void writeLine(char, const int *, unsigned);
+    void putByte(char);
+    void swapBuffers();
+    void writeBuffers();
+};
+
+inline void DratWriter::putByte(char byte) {
+    if (position == bufferCapacity)
+        swapBuffers();
+    buffers[currentBuffer][position++] = byte;
+}
+
+#endif // DRATWRITER_H
@@ -22,21 +22,57 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Uncomment the following line to compile the scoped event tracing into the solver and the generator.
+# A Chrome/Perfetto trace is then written to the file named by the SOLVER_TRACE environment variable.
+#DEFINES += SOLVER_TRACING
+
 CONFIG += c++11
 
 SOURCES += \
+        CNFFeatures.cpp \
+        CNFInstance.cpp \
+        CNFFormula.cpp \
+        CNFResultCache.cpp \
         CNFSolver.cpp \
-        CNFSolverThread.cpp \
-        SudokuGeneratorThread.cpp \
+        CNFSolverJob.cpp \
+        CNFSolverTask.cpp \
+        CheckpointWriter.cpp \
+        DratWriter.cpp \
+        JobScheduler.cpp \
+        LocalSearchSolver.cpp \
+        SudokuBatchJob.cpp \
+        SudokuBatchSolver.cpp \
+        SudokuCache.cpp \
+        SudokuGenerator.cpp \
+        SudokuGeneratorJob.cpp \
+        Trace.cpp \
+        XorMatrix.cpp \
         main.cpp \
         MainWindow.cpp
 
 HEADERS += \
+        CNFFeatures.h \
+        CNFInstance.h \
+        CNFFormula.h \
+        CNFResultCache.h \
         CNFSolver.h \
-        CNFSolverThread.h \
+        CNFSolverJob.h \
+        CNFSolverTask.h \
+        CheckpointWriter.h \
+        DratWriter.h \
+        JobScheduler.h \
         List.h \
+        LocalSearchSolver.h \
         MainWindow.h \
-        SudokuGeneratorThread.h
+        NodeAllocator.h \
+        SudokuBatchJob.h \
+        SudokuBatchSolver.h \
+        SudokuCache.h \
+        SudokuGenerator.h \
+        SudokuGeneratorJob.h \
+        TextFormatter.h \
+        Trace.h \
+        XorMatrix.h
 
 FORMS += \
         MainWindow.ui
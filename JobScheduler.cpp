@@ -0,0 +1,137 @@
+#include "JobScheduler.h"
+#include <algorithm>
+
+JobScheduler::Job::Job(JobScheduler *scheduler, const QString &name, Priority priority, std::function<void(const Job &)> task)
+    : scheduler(scheduler),
+      name(name),
+      priority(priority),
+      cancelFlag(false),
+      task(std::move(task)),
+      lentWorkerNum(0) {}
+
+unsigned JobScheduler::Job::borrowWorkers(unsigned maxNum) const {
+    std::lock_guard<std::mutex> lock(scheduler->mutex);
+    unsigned workerNum = static_cast<unsigned>(scheduler->workers.size());
+    unsigned busyWorkerNum = static_cast<unsigned>(scheduler->runningJobs.size()) + scheduler->lentWorkerNum;
+    unsigned num = busyWorkerNum < workerNum ? std::min(maxNum, workerNum - busyWorkerNum) : 0;
+    scheduler->lentWorkerNum += num;
+    lentWorkerNum += num;
+    return num;
+}
+
+void JobScheduler::Job::returnWorkers(unsigned num) const {
+    {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        num = std::min(num, lentWorkerNum);
+        scheduler->lentWorkerNum -= num;
+        lentWorkerNum -= num;
+    }
+    scheduler->condition.notify_all();
+}
+
+JobScheduler::JobScheduler(unsigned workerNum, unsigned queueCapacity, QObject *parent)
+    : QObject(parent),
+      queueCapacity(queueCapacity),
+      queuedJobNum(0),
+      lentWorkerNum(0),
+      isStopping(false) {
+    for (unsigned i = 0; i < std::max(1u, workerNum); ++i)
+        workers.emplace_back(&JobScheduler::work, this);
+}
+
+JobScheduler::~JobScheduler() {
+    cancelAll();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    condition.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+JobScheduler::JobHandle JobScheduler::submit(const QString &name, Priority priority, std::function<void(const Job &)> task) {
+    JobHandle job(new Job(this, name, priority, std::move(task)));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queuedJobNum >= queueCapacity)
+            return nullptr;
+        queues[priority].push_back(job);
+        ++queuedJobNum;
+    }
+    condition.notify_one();
+    emit statusChanged();
+    return job;
+}
+
+void JobScheduler::cancel(const JobHandle &job) {
+    if (job != nullptr)
+        job->cancelFlag.store(true, std::memory_order_relaxed);
+}
+
+void JobScheduler::cancelAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::deque<JobHandle> &queue : queues) {
+        for (const JobHandle &job : queue)
+            job->cancelFlag.store(true, std::memory_order_relaxed);
+    }
+    for (const JobHandle &job : runningJobs)
+        job->cancelFlag.store(true, std::memory_order_relaxed);
+}
+
+unsigned JobScheduler::getWorkerNum() const {
+    return static_cast<unsigned>(workers.size());
+}
+
+unsigned JobScheduler::getQueueCapacity() const {
+    return queueCapacity;
+}
+
+unsigned JobScheduler::getQueuedJobNum() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queuedJobNum;
+}
+
+QStringList JobScheduler::getRunningJobNames() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    QStringList names;
+    for (const JobHandle &job : runningJobs)
+        names.append(job->name);
+    return names;
+}
+
+//the queued jobs are still run while stopping, so every task can report its cancellation and clean up
+void JobScheduler::work() {
+    while (true) {
+        JobHandle job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] {
+                return (queuedJobNum > 0 && runningJobs.size() + lentWorkerNum < workers.size()) || isStopping;
+            });
+            if (queuedJobNum == 0)
+                return;
+            for (int priority = High; priority >= Low; --priority) {
+                if (!queues[priority].empty()) {
+                    job = queues[priority].front();
+                    queues[priority].pop_front();
+                    break;
+                }
+            }
+            --queuedJobNum;
+            runningJobs.push_back(job);
+        }
+        emit statusChanged();
+        job->task(*job);
+        job->task = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            runningJobs.erase(std::find(runningJobs.begin(), runningJobs.end(), job));
+            lentWorkerNum -= job->lentWorkerNum;
+            job->lentWorkerNum = 0;
+        }
+        //a finished job may leave room for more than one queued job
+        condition.notify_all();
+        emit statusChanged();
+    }
+}
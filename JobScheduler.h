@@ -0,0 +1,118 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//application-wide pool of a fixed number of worker threads running solver and generator jobs
+//queued jobs wait in one FIFO queue per priority, the highest priority is served first,
+//and a job is refused when the queue is full so the caller can retry or report it
+//canceling only sets the flag of a job: a queued job still runs and should return at once,
+//a running job is expected to poll the flag
+//a running job with threads of its own borrows idle workers for them, a lent worker takes no job until it is
+//given back, so the jobs and their threads never outnumber the workers
+class JobScheduler : public QObject {
+    Q_OBJECT
+
+public:
+
+    enum Priority {
+        Low, //batch files
+        Normal, //a single CNF file
+        High //interactive Sudoku work
+    };
+
+    class Job {
+
+    public:
+
+        const QString &getName() const;
+        Priority getPriority() const;
+        bool isCanceled() const;
+        const std::atomic<bool> &getCancelFlag() const; //for the solvers that poll a flag themselves
+        unsigned borrowWorkers(unsigned) const; //at most the given number of idle workers, returns how many are lent
+        void returnWorkers(unsigned) const; //the workers still lent when the job ends are given back by the scheduler
+
+        //disable all the unused functions
+        Job(const Job &) = delete;
+        Job(Job &&) = delete;
+        Job &operator=(const Job &) = delete;
+        Job &operator=(Job &&) = delete;
+
+    private:
+
+        JobScheduler *scheduler;
+        QString name;
+        Priority priority;
+        std::atomic<bool> cancelFlag;
+        std::function<void(const Job &)> task; //released once the job is done
+        mutable unsigned lentWorkerNum; //guarded by the lock of the scheduler
+
+        Job(JobScheduler *, const QString &, Priority, std::function<void(const Job &)>);
+
+        friend class JobScheduler;
+    };
+
+    using JobHandle = std::shared_ptr<Job>;
+
+    JobScheduler(unsigned workerNum, unsigned queueCapacity, QObject *parent = nullptr);
+    ~JobScheduler(); //cancels all the jobs and waits for the running ones
+    JobHandle submit(const QString &, Priority, std::function<void(const Job &)>); //nullptr when the queue is full
+    void cancel(const JobHandle &);
+    void cancelAll();
+    unsigned getWorkerNum() const;
+    unsigned getQueueCapacity() const;
+    unsigned getQueuedJobNum() const;
+    QStringList getRunningJobNames() const;
+
+    //disable all the unused functions
+    JobScheduler(const JobScheduler &) = delete;
+    JobScheduler(JobScheduler &&) = delete;
+    JobScheduler &operator=(const JobScheduler &) = delete;
+    JobScheduler &operator=(JobScheduler &&) = delete;
+
+signals:
+    void statusChanged(); //a job was queued, started or finished, emitted from any thread
+
+private:
+
+    const unsigned queueCapacity;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<JobHandle> queues[3]; //indexed by priority
+    unsigned queuedJobNum;
+    std::vector<JobHandle> runningJobs;
+    unsigned lentWorkerNum; //idle workers lent to running jobs
+    bool isStopping;
+
+    void work();
+};
+
+inline const QString &JobScheduler::Job::getName() const {
+    return name;
+}
+
+inline JobScheduler::Priority JobScheduler::Job::getPriority() const {
+    return priority;
+}
+
+inline bool JobScheduler::Job::isCanceled() const {
+    return cancelFlag.load(std::memory_order_relaxed);
+}
+
+inline const std::atomic<bool> &JobScheduler::Job::getCancelFlag() const {
+    return cancelFlag;
+}
+
+#endif // JOBSCHEDULER_H
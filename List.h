@@ -1,11 +1,13 @@
 #pragma once
 
+#include "NodeAllocator.h"
 #include <utility>
 #include <cstddef>
 
 //single linked list implementation, limited functions ver.
 //it can also be used as a stack or a queue
-template <typename T>
+//nodes are recycled through a thread-local pool unless another allocator policy is given
+template <typename T, typename Allocator = DefaultNodeAllocator>
 class List {
 
 	struct Node {
@@ -43,7 +45,7 @@ public:
 
         Iterator(Node *p) : current(p) {}
 
-		friend class List<T>;
+		friend class List;
 	};
 
 	//constructors and destructor
@@ -81,62 +83,66 @@ private:
     unsigned mSize;
 
 	void free();
+
+    template <typename U>
+    static Node *createNode(U &&, Node *);
+    static void destroyNode(Node *);
 };
 
-template <typename T>
-List<T>::List() : head(nullptr), tail(nullptr), mSize(0) {}
+template <typename T, typename Allocator>
+List<T, Allocator>::List() : head(nullptr), tail(nullptr), mSize(0) {}
 
-template <typename T>
-List<T>::List(const List &list) : head(nullptr), tail(nullptr), mSize(list.mSize) {
+template <typename T, typename Allocator>
+List<T, Allocator>::List(const List &list) : head(nullptr), tail(nullptr), mSize(list.mSize) {
     Node **piter = &head;
     Node *iter = list.head;
 	while (iter != nullptr) {
-        *piter = new Node(iter->element, nullptr);
+        *piter = createNode(iter->element, nullptr);
         tail = *piter;
         piter = &(*piter)->next;
 		iter = iter->next;
 	}
 }
 
-template <typename T>
-List<T>::List(List &&list) noexcept : head(list.head), tail(list.tail), mSize(list.mSize) {
+template <typename T, typename Allocator>
+List<T, Allocator>::List(List &&list) noexcept : head(list.head), tail(list.tail), mSize(list.mSize) {
     list.head = nullptr;
     list.tail = nullptr;
     list.mSize = 0;
 }
 
-template <typename T>
-List<T>::~List() {
+template <typename T, typename Allocator>
+List<T, Allocator>::~List() {
 	free();
 }
 
-template <typename T>
-List<T>& List<T>::operator=(const List &list) {
+template <typename T, typename Allocator>
+List<T, Allocator> &List<T, Allocator>::operator=(const List &list) {
 	List copy = list;
 	std::swap(*this, copy);
 	return *this;
 }
 
-template <typename T>
-List<T>& List<T>::operator=(List &&list) noexcept {
+template <typename T, typename Allocator>
+List<T, Allocator> &List<T, Allocator>::operator=(List &&list) noexcept {
     std::swap(head, list.head);
     std::swap(tail, list.tail);
     std::swap(mSize, list.mSize);
 	return *this;
 }
 
-template <typename T>
-bool List<T>::isEmpty() const {
+template <typename T, typename Allocator>
+bool List<T, Allocator>::isEmpty() const {
     return mSize == 0;
 }
 
-template <typename T>
-unsigned List<T>::size() const {
+template <typename T, typename Allocator>
+unsigned List<T, Allocator>::size() const {
     return mSize;
 }
 
-template <typename T>
-bool List<T>::doesContain(const T &element) const {
+template <typename T, typename Allocator>
+bool List<T, Allocator>::doesContain(const T &element) const {
     Node *iter = head;
 	while (iter != nullptr) {
 		if (iter->element == element)
@@ -146,91 +152,91 @@ bool List<T>::doesContain(const T &element) const {
 	return false;
 }
 
-template <typename T>
-const T &List<T>::front() const {
+template <typename T, typename Allocator>
+const T &List<T, Allocator>::front() const {
     return head->element;
 }
 
-template <typename T>
-T &List<T>::front() {
+template <typename T, typename Allocator>
+T &List<T, Allocator>::front() {
     return head->element;
 }
 
-template <typename T>
-const T &List<T>::back() const {
+template <typename T, typename Allocator>
+const T &List<T, Allocator>::back() const {
     return tail->element;
 }
 
-template <typename T>
-T &List<T>::back() {
+template <typename T, typename Allocator>
+T &List<T, Allocator>::back() {
     return tail->element;
 }
 
-template <typename T>
-typename List<T>::Iterator List<T>::iterator() const {
+template <typename T, typename Allocator>
+typename List<T, Allocator>::Iterator List<T, Allocator>::iterator() const {
     return Iterator(head);
 }
 
-template <typename T>
-void List<T>::addFront(const T &element) {
-    head = new Node(element, head);
+template <typename T, typename Allocator>
+void List<T, Allocator>::addFront(const T &element) {
+    head = createNode(element, head);
     ++mSize;
     if (mSize == 1)
         tail = head;
 }
 
-template <typename T>
-void List<T>::addFront(T &&element) {
-    head = new Node(std::move(element), head);
+template <typename T, typename Allocator>
+void List<T, Allocator>::addFront(T &&element) {
+    head = createNode(std::move(element), head);
     ++mSize;
     if (mSize == 1)
         tail = head;
 }
 
-template <typename T>
-void List<T>::removeFront() {
+template <typename T, typename Allocator>
+void List<T, Allocator>::removeFront() {
     Node *nodeToDelete = head;
     head = head->next;
-    delete nodeToDelete;
+    destroyNode(nodeToDelete);
     --mSize;
     if (head == nullptr)
         tail = nullptr;
 }
 
-template <typename T>
-void List<T>::addBack(const T &element) {
+template <typename T, typename Allocator>
+void List<T, Allocator>::addBack(const T &element) {
     if (tail == nullptr) {
-        tail = new Node(element, nullptr);
+        tail = createNode(element, nullptr);
         head = tail;
 	}
 	else {
-        tail->next = new Node(element, nullptr);
+        tail->next = createNode(element, nullptr);
         tail = tail->next;
 	}
     ++mSize;
 }
 
-template <typename T>
-void List<T>::addBack(T &&element) {
+template <typename T, typename Allocator>
+void List<T, Allocator>::addBack(T &&element) {
     if (tail == nullptr) {
-        tail = new Node(std::move(element), nullptr);
+        tail = createNode(std::move(element), nullptr);
         head = tail;
 	}
 	else {
-        tail->next = new Node(std::move(element), nullptr);
+        tail->next = createNode(std::move(element), nullptr);
         tail = tail->next;
 	}
     ++mSize;
 }
 
-template <typename T>
-void List<T>::removeFirstOf(const T &element) {
+template <typename T, typename Allocator>
+void List<T, Allocator>::removeFirstOf(const T &element) {
     Node **piter = &head;
     while (*piter != nullptr) {
         if ((*piter)->element == element) {
             Node *nodeToDelete = *piter;
             *piter = (*piter)->next;
-            delete nodeToDelete;
+            destroyNode(nodeToDelete);
             --mSize;
             if (*piter == nullptr)
                 tail = reinterpret_cast<Node *>(reinterpret_cast<char *>(piter) - reinterpret_cast<size_t>(&(reinterpret_cast<Node *>(0)->next)));
@@ -240,8 +246,8 @@ void List<T>::removeFirstOf(const T &element) {
 	}
 }
 
-template <typename T>
-void List<T>::clear() {
+template <typename T, typename Allocator>
+void List<T, Allocator>::clear() {
     if (mSize != 0) {
 		free();
         head = nullptr;
@@ -250,12 +256,24 @@ void List<T>::clear() {
 	}
 }
 
-template <typename T>
-void List<T>::free() {
+template <typename T, typename Allocator>
+void List<T, Allocator>::free() {
     Node *iter = head;
 	while (iter != nullptr) {
         Node *nodeToDelete = iter;
 		iter = iter->next;
-        delete nodeToDelete;
+        destroyNode(nodeToDelete);
 	}
 }
+
+template <typename T, typename Allocator>
+template <typename U>
+inline typename List<T, Allocator>::Node *List<T, Allocator>::createNode(U &&element, Node *next) {
+    return new (Allocator::template allocate<Node>()) Node(std::forward<U>(element), next);
+}
+
+template <typename T, typename Allocator>
+inline void List<T, Allocator>::destroyNode(Node *node) {
+    node->~Node();
+    Allocator::template deallocate<Node>(node);
+}
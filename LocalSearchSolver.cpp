@@ -0,0 +1,278 @@
+#include "LocalSearchSolver.h"
+#include "TextFormatter.h"
+#include "Trace.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+LocalSearchSolver::LocalSearchSolver(const CNFFormula &formula, Algorithm algorithm, unsigned seed)
+    : formula(formula),
+      algorithm(algorithm),
+      randomGenerator(seed),
+      variableNum(formula.getVariableNum()),
+      clauseNum(formula.getClauseNum()),
+      occurOffsets(new unsigned[2 * variableNum + 3]()),
+      occurClauses(new unsigned[formula.getLiteralNum() + 1]),
+      values(new bool[variableNum + 1]()),
+      breakCounts(new unsigned[variableNum + 1]()),
+      makeCounts(new unsigned[variableNum + 1]()),
+      trueLiteralNums(new unsigned[clauseNum + 1]()),
+      trueVariableSums(new unsigned[clauseNum + 1]()),
+      unsatisfiedClauses(new unsigned[clauseNum + 1]),
+      unsatisfiedPositions(new unsigned[clauseNum + 1]),
+      unsatisfiedClauseNum(0),
+      candidateWeights(nullptr),
+      maxClauseLength(0) {
+    TRACE_SCOPE("LocalSearchSolver::LocalSearchSolver");
+    //counting sort of all the literal occurrences by literal index
+    for (unsigned i = 0; i < clauseNum; ++i) {
+        const int *literals = formula.getClauseLiterals(i);
+        unsigned length = formula.getClauseLength(i);
+        for (unsigned j = 0; j < length; ++j)
+            ++occurOffsets[getLiteralIndex(literals[j]) + 1];
+        if (length > maxClauseLength)
+            maxClauseLength = length;
+    }
+    for (unsigned i = 1; i < 2 * variableNum + 3; ++i)
+        occurOffsets[i] += occurOffsets[i - 1];
+    unsigned *positions = new unsigned[2 * variableNum + 2];
+    for (unsigned i = 0; i < 2 * variableNum + 2; ++i)
+        positions[i] = occurOffsets[i];
+    for (unsigned i = 0; i < clauseNum; ++i) {
+        const int *literals = formula.getClauseLiterals(i);
+        unsigned length = formula.getClauseLength(i);
+        for (unsigned j = 0; j < length; ++j)
+            occurClauses[positions[getLiteralIndex(literals[j])]++] = i;
+    }
+    delete[] positions;
+    candidateWeights = new double[maxClauseLength + 1];
+
+    //polynomial break weights (eps + break)^-cb, cb as tuned for 3-SAT and longer clauses
+    double cb = maxClauseLength <= 3 ? 2.38 : maxClauseLength <= 5 ? 3.1 : 3.7;
+    for (unsigned i = 0; i < 64; ++i)
+        probabilities[i] = std::pow(0.9 + i, -cb);
+}
+
+LocalSearchSolver::~LocalSearchSolver() {
+    delete[] occurOffsets;
+    delete[] occurClauses;
+    delete[] values;
+    delete[] breakCounts;
+    delete[] makeCounts;
+    delete[] trueLiteralNums;
+    delete[] trueVariableSums;
+    delete[] unsatisfiedClauses;
+    delete[] unsatisfiedPositions;
+    delete[] candidateWeights;
+}
+
+bool LocalSearchSolver::isSatisfied(unsigned long long maxFlipNum) {
+    using namespace std::chrono;
+    TRACE_SCOPE("LocalSearchSolver::isSatisfied");
+
+    auto begin = steady_clock::now();
+    //an empty clause can never be satisfied
+    bool result = true;
+    for (unsigned i = 0; i < clauseNum && result; ++i)
+        result = formula.getClauseLength(i) != 0;
+    if (result) {
+        initialize();
+        statistics.minUnsatisfiedClauseNum = unsatisfiedClauseNum;
+        //restart from a fresh random assignment whenever progress stalls for a while
+        unsigned long long restartInterval = 100000ULL + 100ULL * variableNum;
+        unsigned long long lastImprovementFlip = 0;
+        unsigned bestSinceRestart = unsatisfiedClauseNum;
+        while (unsatisfiedClauseNum != 0 && statistics.flipNum < maxFlipNum) {
+            if (statistics.flipNum - lastImprovementFlip > restartInterval) {
+                ++statistics.restartNum;
+                initialize();
+                lastImprovementFlip = statistics.flipNum;
+                bestSinceRestart = unsatisfiedClauseNum;
+                continue;
+            }
+            unsigned clauseIndex = unsatisfiedClauses[randomGenerator() % unsatisfiedClauseNum];
+            flip(algorithm == ProbSAT ? pickProbSATVariable(clauseIndex) : pickWalkSATVariable(clauseIndex));
+            ++statistics.flipNum;
+            if (unsatisfiedClauseNum < bestSinceRestart) {
+                bestSinceRestart = unsatisfiedClauseNum;
+                lastImprovementFlip = statistics.flipNum;
+                if (unsatisfiedClauseNum < statistics.minUnsatisfiedClauseNum)
+                    statistics.minUnsatisfiedClauseNum = unsatisfiedClauseNum;
+            }
+        }
+        result = unsatisfiedClauseNum == 0;
+    }
+    statistics.solveTime += duration_cast<nanoseconds>(steady_clock::now() - begin).count();
+    return result;
+}
+
+bool LocalSearchSolver::printSatisfiabilityInfo(unsigned long long maxFlipNum, std::ostream &output) {
+    return printSatisfiabilityInfo(maxFlipNum, output, output);
+}
+
+//nothing is known when the budget is used up, so the result line is only printed for a model
+bool LocalSearchSolver::printSatisfiabilityInfo(unsigned long long maxFlipNum, std::ostream &output, std::ostream &modelOutput) {
+    bool result = isSatisfied(maxFlipNum);
+    if (result) {
+        output << "s " << result << std::endl;
+        printModel(modelOutput);
+    }
+    else
+        output << "c local search gave up" << std::endl;
+    output << "t " << statistics.solveTime / 1000000.0 << std::endl;
+    printStatistics(output);
+    return result;
+}
+
+void LocalSearchSolver::printModel(std::ostream &output) const {
+    TextFormatter formatter(output);
+    formatter.put('v');
+    formatter.put(' ');
+    for (unsigned i = 1; i <= variableNum; ++i) {
+        if (!values[i])
+            formatter.put('-');
+        formatter.putUnsigned(i);
+        formatter.put(' ');
+    }
+    formatter.put('\n');
+    formatter.flush();
+    output.flush();
+}
+
+void LocalSearchSolver::printStatistics(std::ostream &output) const {
+    output << "c flips " << statistics.flipNum << std::endl;
+    output << "c restarts " << statistics.restartNum << std::endl;
+    output << "c min unsatisfied clauses " << statistics.minUnsatisfiedClauseNum << std::endl;
+}
+
+const LocalSearchSolver::Statistics &LocalSearchSolver::getStatistics() const {
+    return statistics;
+}
+
+bool LocalSearchSolver::getValue(unsigned variable) const {
+    return values[variable];
+}
+
+inline unsigned LocalSearchSolver::getLiteralIndex(int literal) {
+    return 2 * static_cast<unsigned>(std::abs(literal)) + (literal < 0);
+}
+
+inline bool LocalSearchSolver::isTrue(int literal) const {
+    return values[std::abs(literal)] == (literal > 0);
+}
+
+//random assignment, then all the counters from scratch
+void LocalSearchSolver::initialize() {
+    for (unsigned i = 1; i <= variableNum; ++i) {
+        values[i] = (randomGenerator() & 1) != 0;
+        breakCounts[i] = 0;
+        makeCounts[i] = 0;
+    }
+    unsatisfiedClauseNum = 0;
+    for (unsigned i = 0; i < clauseNum; ++i) {
+        const int *literals = formula.getClauseLiterals(i);
+        unsigned length = formula.getClauseLength(i);
+        trueLiteralNums[i] = 0;
+        trueVariableSums[i] = 0;
+        for (unsigned j = 0; j < length; ++j) {
+            if (isTrue(literals[j])) {
+                ++trueLiteralNums[i];
+                trueVariableSums[i] += static_cast<unsigned>(std::abs(literals[j]));
+            }
+        }
+        if (trueLiteralNums[i] == 0) {
+            addUnsatisfiedClause(i);
+            for (unsigned j = 0; j < length; ++j)
+                ++makeCounts[std::abs(literals[j])];
+        }
+        else if (trueLiteralNums[i] == 1)
+            ++breakCounts[trueVariableSums[i]];
+    }
+}
+
+//update the counters of the clauses of the two literals of the variable only
+void LocalSearchSolver::flip(unsigned variable) {
+    values[variable] = !values[variable];
+    unsigned trueIndex = 2 * variable + !values[variable];
+    unsigned falseIndex = trueIndex ^ 1;
+
+    for (unsigned i = occurOffsets[trueIndex]; i < occurOffsets[trueIndex + 1]; ++i) {
+        unsigned clauseIndex = occurClauses[i];
+        ++trueLiteralNums[clauseIndex];
+        if (trueLiteralNums[clauseIndex] == 1) {
+            removeUnsatisfiedClause(clauseIndex);
+            const int *literals = formula.getClauseLiterals(clauseIndex);
+            unsigned length = formula.getClauseLength(clauseIndex);
+            for (unsigned j = 0; j < length; ++j)
+                --makeCounts[std::abs(literals[j])];
+            ++breakCounts[variable];
+        }
+        else if (trueLiteralNums[clauseIndex] == 2)
+            --breakCounts[trueVariableSums[clauseIndex]]; //the only true literal is not critical any more
+        trueVariableSums[clauseIndex] += variable;
+    }
+
+    for (unsigned i = occurOffsets[falseIndex]; i < occurOffsets[falseIndex + 1]; ++i) {
+        unsigned clauseIndex = occurClauses[i];
+        --trueLiteralNums[clauseIndex];
+        trueVariableSums[clauseIndex] -= variable;
+        if (trueLiteralNums[clauseIndex] == 0) {
+            addUnsatisfiedClause(clauseIndex);
+            const int *literals = formula.getClauseLiterals(clauseIndex);
+            unsigned length = formula.getClauseLength(clauseIndex);
+            for (unsigned j = 0; j < length; ++j)
+                ++makeCounts[std::abs(literals[j])];
+            --breakCounts[variable];
+        }
+        else if (trueLiteralNums[clauseIndex] == 1)
+            ++breakCounts[trueVariableSums[clauseIndex]]; //the remaining true literal became critical
+    }
+}
+
+inline void LocalSearchSolver::addUnsatisfiedClause(unsigned clauseIndex) {
+    unsatisfiedPositions[clauseIndex] = unsatisfiedClauseNum;
+    unsatisfiedClauses[unsatisfiedClauseNum++] = clauseIndex;
+}
+
+//move the last clause into the hole
+inline void LocalSearchSolver::removeUnsatisfiedClause(unsigned clauseIndex) {
+    unsigned lastClause = unsatisfiedClauses[--unsatisfiedClauseNum];
+    unsatisfiedClauses[unsatisfiedPositions[clauseIndex]] = lastClause;
+    unsatisfiedPositions[lastClause] = unsatisfiedPositions[clauseIndex];
+}
+
+unsigned LocalSearchSolver::pickProbSATVariable(unsigned clauseIndex) {
+    const int *literals = formula.getClauseLiterals(clauseIndex);
+    unsigned length = formula.getClauseLength(clauseIndex);
+    double weightSum = 0;
+    for (unsigned j = 0; j < length; ++j) {
+        unsigned breakCount = breakCounts[std::abs(literals[j])];
+        candidateWeights[j] = probabilities[breakCount < 63 ? breakCount : 63];
+        weightSum += candidateWeights[j];
+    }
+    double threshold = std::uniform_real_distribution<double>(0, weightSum)(randomGenerator);
+    for (unsigned j = 0; j + 1 < length; ++j) {
+        threshold -= candidateWeights[j];
+        if (threshold <= 0)
+            return static_cast<unsigned>(std::abs(literals[j]));
+    }
+    return static_cast<unsigned>(std::abs(literals[length - 1]));
+}
+
+unsigned LocalSearchSolver::pickWalkSATVariable(unsigned clauseIndex) {
+    const unsigned noise = 567; //per thousand
+    const int *literals = formula.getClauseLiterals(clauseIndex);
+    unsigned length = formula.getClauseLength(clauseIndex);
+    unsigned best = static_cast<unsigned>(std::abs(literals[0]));
+    for (unsigned j = 1; j < length; ++j) {
+        unsigned variable = static_cast<unsigned>(std::abs(literals[j]));
+        //fewer breaks first, more makes on ties
+        if (breakCounts[variable] < breakCounts[best]
+                || (breakCounts[variable] == breakCounts[best] && makeCounts[variable] > makeCounts[best]))
+            best = variable;
+    }
+    //a freebie move is always taken
+    if (breakCounts[best] == 0 || randomGenerator() % 1000 >= noise)
+        return best;
+    return static_cast<unsigned>(std::abs(literals[randomGenerator() % length]));
+}
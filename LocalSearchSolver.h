@@ -0,0 +1,86 @@
+#ifndef LOCALSEARCHSOLVER_H
+#define LOCALSEARCHSOLVER_H
+
+#include "CNFFormula.h"
+#include <iostream>
+#include <random>
+
+//stochastic local search for satisfiable formulas, it can find models but never prove unsatisfiability
+//ProbSAT picks a variable of a random unsatisfied clause with probability decreasing in its break count
+//WalkSAT takes a random variable with the noise probability and a least breaking one otherwise
+class LocalSearchSolver {
+
+public:
+
+    enum Algorithm {
+        ProbSAT,
+        WalkSAT
+    };
+
+    struct Statistics {
+        unsigned long long flipNum;
+        unsigned long long restartNum;
+        unsigned minUnsatisfiedClauseNum;
+        unsigned long long solveTime; //in nanoseconds
+
+        Statistics() : flipNum(0), restartNum(0), minUnsatisfiedClauseNum(0), solveTime(0) {}
+    };
+
+    explicit LocalSearchSolver(const CNFFormula &, Algorithm algorithm = ProbSAT, unsigned seed = 0);
+    ~LocalSearchSolver();
+    bool isSatisfied(unsigned long long); //give up after the flip budget is used up
+    bool printSatisfiabilityInfo(unsigned long long, std::ostream &);
+    bool printSatisfiabilityInfo(unsigned long long, std::ostream &, std::ostream &); //the model line goes to the second stream
+    void printModel(std::ostream &) const;
+    void printStatistics(std::ostream &) const;
+    const Statistics &getStatistics() const;
+    bool getValue(unsigned) const; //value of a variable in the last assignment
+
+    //disable all the unused functions
+    LocalSearchSolver(const LocalSearchSolver &) = delete;
+    LocalSearchSolver(LocalSearchSolver &&) = delete;
+    LocalSearchSolver &operator=(const LocalSearchSolver &) = delete;
+    LocalSearchSolver &operator=(LocalSearchSolver &&) = delete;
+
+private:
+
+    const CNFFormula &formula;
+    Algorithm algorithm;
+    std::mt19937 randomGenerator;
+
+    unsigned variableNum;
+    unsigned clauseNum;
+
+    //occurrence lists indexed by 2 * variable + (literal < 0), stored back to back
+    unsigned *occurOffsets; //array size decided by 2 * variableNum + 3
+    unsigned *occurClauses; //array size decided by the number of literals
+
+    bool *values; //array size decided by variableNum + 1
+    unsigned *breakCounts; //clauses that become unsatisfied if the variable is flipped
+    unsigned *makeCounts; //clauses that become satisfied if the variable is flipped
+
+    unsigned *trueLiteralNums; //array size decided by clauseNum
+    unsigned *trueVariableSums; //sum of the variables of true literals, the critical variable when only one is true
+
+    //unsatisfied clauses in any order, positions make removal O(1)
+    unsigned *unsatisfiedClauses;
+    unsigned *unsatisfiedPositions;
+    unsigned unsatisfiedClauseNum;
+
+    double probabilities[64]; //ProbSAT weights of break counts, the last one is used for larger counts
+    double *candidateWeights;
+    unsigned maxClauseLength;
+
+    Statistics statistics;
+
+    static unsigned getLiteralIndex(int);
+    bool isTrue(int) const;
+    void initialize();
+    void flip(unsigned);
+    void addUnsatisfiedClause(unsigned);
+    void removeUnsatisfiedClause(unsigned);
+    unsigned pickProbSATVariable(unsigned);
+    unsigned pickWalkSATVariable(unsigned);
+};
+
+#endif // LOCALSEARCHSOLVER_H
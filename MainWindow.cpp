@@ -1,21 +1,54 @@
 #include "MainWindow.h"
 #include "ui_MainWindow.h"
-#include "CNFSolverThread.h"
-#include "SudokuGeneratorThread.h"
+#include "CNFSolverJob.h"
+#include "CNFResultCache.h"
+#include "SudokuGenerator.h"
+#include "SudokuGeneratorJob.h"
+#include "SudokuBatchJob.h"
+#include "CNFSolverTask.h"
+#include <memory>
 #include <QFileDialog>
+#include <QThread>
+#include <QDir>
+#include <QFileInfo>
+#include <QTimer>
+#include <QTextCursor>
 #include <QTextCodec>
 #include <QMessageBox>
+#include <QStandardPaths>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
-      ui(new Ui::MainWindow) {
+      ui(new Ui::MainWindow),
+      sudokuSeed(0),
+      pendingResultPosition(0),
+      scheduler(new JobScheduler(static_cast<unsigned>(QThread::idealThreadCount()), 64, this)),
+      batchFileNum(0),
+      batchSubmittedNum(0),
+      batchDoneNum(0),
+      batchSatisfiedNum(0),
+      batchUnsatisfiedNum(0) {
     ui->setupUi(this);
-    ui->dlcsRadioButton->setChecked(true);
+    ui->autoRadioButton->setChecked(true);
     connect(ui->runButton, &QPushButton::clicked, this, &MainWindow::runCNFSolver);
+    ui->workerSpinBox->setValue(QThread::idealThreadCount());
+    ui->engineComboBox->addItem("DPLL", CNFSolverJob::Options::Complete);
+    ui->engineComboBox->addItem("Local search", CNFSolverJob::Options::LocalSearch);
+    ui->engineComboBox->addItem("Local search + DPLL", CNFSolverJob::Options::LocalSearchFirst);
+    //results are kept across runs in the cache location of the application
+    QString resultCacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/cnf-results";
+    if (QDir().mkpath(resultCacheDirectory))
+        CNFResultCache::getInstance().setDirectory(QTextCodec::codecForLocale()->fromUnicode(resultCacheDirectory).data());
+    else
+        ui->resultCacheCheckBox->setEnabled(false);
+    connect(ui->batchFilesButton, &QPushButton::clicked, this, &MainWindow::runBatchFiles);
+    connect(ui->batchFolderButton, &QPushButton::clicked, this, &MainWindow::runBatchFolder);
+    ui->batchTableWidget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
 
     connect(ui->generateButton, &QPushButton::clicked, this, &MainWindow::generateSudoku);
     connect(ui->checkButton, &QPushButton::clicked, this, &MainWindow::checkSudoku);
     connect(ui->solveButton, &QPushButton::clicked, this, &MainWindow::solveSudoku);
+    connect(ui->solveFileButton, &QPushButton::clicked, this, &MainWindow::solveSudokuFile);
     ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     ui->tableWidget->verticalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     for (int i = 0; i < 9; ++i) {
@@ -27,9 +60,16 @@ MainWindow::MainWindow(QWidget *parent)
     }
     ui->checkButton->setEnabled(false);
     ui->solveButton->setEnabled(false);
+
+    //queued, so a job submitted from this thread does not update the status in the middle of submitting
+    connect(scheduler, &JobScheduler::statusChanged, this, &MainWindow::updateJobStatus, Qt::QueuedConnection);
+    connect(ui->cancelJobsButton, &QPushButton::clicked, this, &MainWindow::cancelJobs);
+    updateJobStatus();
 }
 
 MainWindow::~MainWindow() {
+    //the scheduler cancels the jobs and waits for the running ones
+    delete scheduler;
     delete ui;
 }
 
@@ -40,15 +80,191 @@ void MainWindow::runCNFSolver() {
     else {
         QTextCodec *code = QTextCodec::codecForLocale();
         std::string stdFileName = code->fromUnicode(fileName).data();
-        CNFSolverThread *solverThread = new CNFSolverThread(stdFileName, ui->momsRadioButton->isChecked());
-        connect(solverThread, &CNFSolverThread::finished, solverThread, &CNFSolverThread::deleteLater);
-        connect(solverThread, &CNFSolverThread::sendResult, this, &MainWindow::appendResult, Qt::AutoConnection);
-        solverThread->start();
+        //the job object is deleted in this thread once the scheduler drops the job
+        std::shared_ptr<CNFSolverJob> solverJob(new CNFSolverJob(stdFileName, getSolverOptions()),
+                                                      [](CNFSolverJob *job) { job->deleteLater(); });
+        connect(solverJob.get(), &CNFSolverJob::sendResult, this, &MainWindow::appendResult, Qt::AutoConnection);
+        connect(solverJob.get(), &CNFSolverJob::sendProgress, this, &MainWindow::showProgress, Qt::AutoConnection);
+        if (scheduler->submit(QFileInfo(fileName).fileName(), JobScheduler::Normal,
+                              [solverJob](const JobScheduler::Job &job) { solverJob->run(job); }) == nullptr)
+            ui->textBrowser->append("Too many jobs are queued, try again later!\n");
     }
 }
 
 void MainWindow::appendResult(QString result) {
-    ui->textBrowser->append(result);
+    ui->progressLabel->setText("");
+    pendingResults.append(result);
+    if (pendingResults.size() == 1)
+        appendPendingResultChunk();
+}
+
+//a large result is appended in pieces of at most 16K characters, one piece per event loop iteration,
+//so a model of a million variables does not freeze the window
+//the first piece starts a paragraph like append does, the others are inserted at the end as they are,
+//so the text reads the same as the output of the solver
+void MainWindow::appendPendingResultChunk() {
+    const int chunkSize = 1 << 14;
+    const QString &result = pendingResults.first();
+    int end = result.size();
+    if (result.size() - pendingResultPosition > chunkSize) {
+        //break after a line end or at least after the space between two literals
+        end = result.lastIndexOf('\n', pendingResultPosition + chunkSize - 1) + 1;
+        if (end <= pendingResultPosition)
+            end = result.lastIndexOf(' ', pendingResultPosition + chunkSize - 1) + 1;
+        if (end <= pendingResultPosition)
+            end = pendingResultPosition + chunkSize;
+    }
+    QString chunk = result.mid(pendingResultPosition, end - pendingResultPosition);
+    if (pendingResultPosition == 0)
+        ui->textBrowser->append(chunk);
+    else {
+        QTextCursor cursor(ui->textBrowser->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(chunk);
+    }
+    if (end == result.size()) {
+        pendingResults.removeFirst();
+        pendingResultPosition = 0;
+    }
+    else
+        pendingResultPosition = end;
+    if (!pendingResults.isEmpty())
+        QTimer::singleShot(0, this, &MainWindow::appendPendingResultChunk);
+}
+
+void MainWindow::showProgress(QString progress) {
+    ui->progressLabel->setText(progress);
+}
+
+void MainWindow::runBatchFiles() {
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, "Choose CNF files to run the solver", ".", "*.cnf");
+    if (fileNames.isEmpty())
+        ui->textBrowser->append("No selected file!\n");
+    else
+        startBatch(fileNames);
+}
+
+void MainWindow::runBatchFolder() {
+    QString folderName = QFileDialog::getExistingDirectory(this, "Choose a folder of CNF files to run the solver", ".");
+    if (folderName.isEmpty()) {
+        ui->textBrowser->append("No selected folder!\n");
+        return;
+    }
+    QDir folder(folderName);
+    QStringList fileNames;
+    for (const QString &entry : folder.entryList(QStringList("*.cnf"), QDir::Files, QDir::Name))
+        fileNames.append(folder.absoluteFilePath(entry));
+    if (fileNames.isEmpty())
+        ui->textBrowser->append("No CNF file in " + folderName + "!\n");
+    else
+        startBatch(fileNames);
+}
+
+CNFSolverJob::Options MainWindow::getSolverOptions() const {
+    CNFSolverJob::Options options;
+    options.engine = static_cast<CNFSolverJob::Options::Engine>(ui->engineComboBox->currentData().toInt());
+    options.flipBudget = 1000000ULL * static_cast<unsigned>(ui->flipSpinBox->value());
+    if (ui->momsRadioButton->isChecked())
+        options.selectedBranchingRule = CNFSolver::MOMS;
+    else if (ui->lookaheadRadioButton->isChecked())
+        options.selectedBranchingRule = CNFSolver::Lookahead;
+    else if (ui->autoRadioButton->isChecked())
+        options.selectedBranchingRule = CNFSolver::Auto;
+    else
+        options.selectedBranchingRule = CNFSolver::DLCS;
+    options.writesProof = ui->proofCheckBox->isChecked();
+    options.writesCheckpoint = ui->checkpointCheckBox->isChecked();
+    options.modelLimit = static_cast<unsigned long long>(ui->modelSpinBox->value());
+    options.renumbersVariables = ui->renumberCheckBox->isChecked();
+    options.writesModelToFile = ui->modelFileCheckBox->isChecked();
+    options.usesResultCache = ui->resultCacheCheckBox->isChecked();
+    return options;
+}
+
+void MainWindow::startBatch(const QStringList &fileNames) {
+    //a new batch starts a new table unless the previous one is still running
+    if (batchDoneNum == batchFileNum) {
+        ui->batchTableWidget->setRowCount(0);
+        batchOptions = getSolverOptions();
+        batchFileNum = 0;
+        batchSubmittedNum = 0;
+        batchDoneNum = 0;
+        batchSatisfiedNum = 0;
+        batchUnsatisfiedNum = 0;
+    }
+    pendingBatchFileNames.append(fileNames);
+    batchFileNum += static_cast<unsigned>(fileNames.size());
+    submitBatchFiles();
+    updateBatchSummary();
+    ui->tabWidget->setCurrentWidget(ui->BatchTab);
+}
+
+//a full queue leaves the files pending, they are tried again when any job is done
+void MainWindow::submitBatchFiles() {
+    while (!pendingBatchFileNames.isEmpty() && batchSubmittedNum - batchDoneNum < static_cast<unsigned>(ui->workerSpinBox->value())) {
+        QString fileName = pendingBatchFileNames.first();
+        std::shared_ptr<CNFSolverTask> task(new CNFSolverTask(fileName, batchOptions),
+                                            [](CNFSolverTask *task) { task->deleteLater(); });
+        connect(task.get(), &CNFSolverTask::sendResult, this, &MainWindow::appendBatchResult, Qt::AutoConnection);
+        if (scheduler->submit(QFileInfo(fileName).fileName(), JobScheduler::Low,
+                              [task](const JobScheduler::Job &job) { task->run(job); }) == nullptr)
+            break;
+        pendingBatchFileNames.removeFirst();
+        ++batchSubmittedNum;
+    }
+}
+
+void MainWindow::appendBatchResult(QString fileName, QString status, double milliseconds, qulonglong decisionNum) {
+    //rows are appended in order of completion
+    int row = ui->batchTableWidget->rowCount();
+    ui->batchTableWidget->insertRow(row);
+    ui->batchTableWidget->setItem(row, 0, new QTableWidgetItem(QFileInfo(fileName).fileName()));
+    ui->batchTableWidget->setItem(row, 1, new QTableWidgetItem(status));
+    ui->batchTableWidget->setItem(row, 2, new QTableWidgetItem(QString::number(milliseconds, 'f', 3)));
+    ui->batchTableWidget->setItem(row, 3, new QTableWidgetItem(QString::number(decisionNum)));
+    ui->batchTableWidget->item(row, 0)->setToolTip(fileName);
+    ++batchDoneNum;
+    if (status == "SAT")
+        ++batchSatisfiedNum;
+    else if (status == "UNSAT")
+        ++batchUnsatisfiedNum;
+    submitBatchFiles();
+    updateBatchSummary();
+}
+
+void MainWindow::updateBatchSummary() {
+    ui->batchSummaryLabel->setText(QString("%1/%2 solved, %3 SAT, %4 UNSAT, %5 UNKNOWN, %6 workers")
+                                   .arg(batchDoneNum)
+                                   .arg(batchFileNum)
+                                   .arg(batchSatisfiedNum)
+                                   .arg(batchUnsatisfiedNum)
+                                   .arg(batchDoneNum - batchSatisfiedNum - batchUnsatisfiedNum)
+                                   .arg(ui->workerSpinBox->value()));
+}
+
+void MainWindow::updateJobStatus() {
+    QStringList runningJobNames = scheduler->getRunningJobNames();
+    unsigned queuedJobNum = scheduler->getQueuedJobNum();
+    QString status = QString("Jobs: %1/%2 workers busy, %3/%4 queued")
+                     .arg(runningJobNames.size())
+                     .arg(scheduler->getWorkerNum())
+                     .arg(queuedJobNum)
+                     .arg(scheduler->getQueueCapacity());
+    if (!runningJobNames.isEmpty())
+        status += ", running " + runningJobNames.join(", ");
+    ui->jobLabel->setText(status);
+    ui->cancelJobsButton->setEnabled(!runningJobNames.isEmpty() || queuedJobNum > 0 || !pendingBatchFileNames.isEmpty());
+    if (!pendingBatchFileNames.isEmpty())
+        submitBatchFiles();
+}
+
+//the batch files not handed to the scheduler yet are dropped from the batch
+void MainWindow::cancelJobs() {
+    scheduler->cancelAll();
+    batchFileNum -= static_cast<unsigned>(pendingBatchFileNames.size());
+    pendingBatchFileNames.clear();
+    updateBatchSummary();
+    updateJobStatus();
 }
 
 void MainWindow::generateSudoku() {
@@ -65,13 +281,23 @@ void MainWindow::generateSudoku() {
             }
         }
         ui->label->setText("Generating...");
+        ui->label->setToolTip("");
         ui->generateButton->setEnabled(false);
         ui->checkButton->setEnabled(false);
         ui->solveButton->setEnabled(false);
-        SudokuGeneratorThread *sudokuThread = new SudokuGeneratorThread(givenCellNum);
-        connect(sudokuThread, &SudokuGeneratorThread::finished, sudokuThread, &SudokuGeneratorThread::deleteLater);
-        connect(sudokuThread, &SudokuGeneratorThread::sendSudokuAndSolution, this, &MainWindow::receiveSudokuAndSolution, Qt::AutoConnection);
-        sudokuThread->start();
+        //a fixed seed gives the same Sudoku again, the seed is shown with the Sudoku to reproduce it
+        sudokuSeed = ui->seedSpinBox->value() == 0 ? SudokuGenerator::getRandomSeed() : static_cast<unsigned>(ui->seedSpinBox->value());
+        unsigned threadNum = ui->parallelDiggingCheckBox->isChecked() ? 0 : 1;
+        SudokuGenerator::DiggingMode diggingMode = ui->backtrackingCheckBox->isChecked() ? SudokuGenerator::Backtracking : SudokuGenerator::InOrder;
+        std::shared_ptr<SudokuGeneratorJob> sudokuJob(new SudokuGeneratorJob(givenCellNum, sudokuSeed, threadNum, diggingMode),
+                                                            [](SudokuGeneratorJob *job) { job->deleteLater(); });
+        connect(sudokuJob.get(), &SudokuGeneratorJob::sendSudokuAndSolution, this, &MainWindow::receiveSudokuAndSolution, Qt::AutoConnection);
+        connect(sudokuJob.get(), &SudokuGeneratorJob::sendProgress, this, &MainWindow::showDiggingProgress, Qt::AutoConnection);
+        if (scheduler->submit(QString("Sudoku with %1 givens").arg(givenCellNum), JobScheduler::High,
+                              [sudokuJob](const JobScheduler::Job &job) { sudokuJob->run(job); }) == nullptr) {
+            ui->label->setText("Too many jobs are queued!");
+            ui->generateButton->setEnabled(true);
+        }
     }
 }
 
@@ -114,10 +340,21 @@ void MainWindow::solveSudoku() {
     ui->generateButton->setEnabled(true);
 }
 
-void MainWindow::receiveSudokuAndSolution(QString sudokuString, QString solutionString) {
+void MainWindow::showDiggingProgress(unsigned givenCellNum, double time) {
+    ui->label->setText(QString("Generating... %1 givens after %2 ms").arg(givenCellNum).arg(time, 0, 'f', 0));
+}
+
+void MainWindow::receiveSudokuAndSolution(QString sudokuString, QString solutionString, QString reachTimeString) {
+    if (sudokuString.isEmpty()) {
+        ui->label->setText("Canceled");
+        ui->generateButton->setEnabled(true);
+        return;
+    }
     this->sudokuString = sudokuString;
     this->solutionString = solutionString;
-    ui->label->setText("");
+    //backtracking settles for the fewest givens it found, which may be more than were asked for
+    ui->label->setText(QString("Seed %1, %2 givens").arg(sudokuSeed).arg(81 - sudokuString.count('0')));
+    ui->label->setToolTip(reachTimeString);
     ui->generateButton->setEnabled(true);
     ui->checkButton->setEnabled(true);
     ui->solveButton->setEnabled(true);
@@ -137,3 +374,27 @@ void MainWindow::receiveSudokuAndSolution(QString sudokuString, QString solution
         }
     }
 }
+
+void MainWindow::solveSudokuFile() {
+    QString fileName = QFileDialog::getOpenFileName(this, "Choose a file of Sudoku puzzles to solve", ".");
+    if (fileName.isEmpty())
+        return;
+    ui->label->setText("Solving " + QFileInfo(fileName).fileName() + "...");
+    ui->solveFileButton->setEnabled(false);
+    std::shared_ptr<SudokuBatchJob> batchJob(new SudokuBatchJob(fileName),
+                                                   [](SudokuBatchJob *job) { job->deleteLater(); });
+    connect(batchJob.get(), &SudokuBatchJob::sendResult, this, &MainWindow::receiveSudokuFileResult, Qt::AutoConnection);
+    if (scheduler->submit(QFileInfo(fileName).fileName(), JobScheduler::Normal,
+                          [batchJob](const JobScheduler::Job &job) { batchJob->run(job); }) == nullptr) {
+        ui->label->setText("Too many jobs are queued!");
+        ui->solveFileButton->setEnabled(true);
+    }
+}
+
+//the report goes to the text browser of the solver tab
+void MainWindow::receiveSudokuFileResult(QString result) {
+    ui->label->setText("");
+    ui->solveFileButton->setEnabled(true);
+    appendResult(result);
+    ui->tabWidget->setCurrentWidget(ui->CNFSolverTab);
+}
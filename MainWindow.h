@@ -1,8 +1,11 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "CNFSolverJob.h"
+#include "JobScheduler.h"
 #include <QMainWindow>
 #include <QString>
+#include <QStringList>
 
 namespace Ui {
 class MainWindow;
@@ -18,15 +21,48 @@ public:
 public slots:
     void runCNFSolver();
     void appendResult(QString);
+    void showProgress(QString);
+    void appendPendingResultChunk();
+    void runBatchFiles();
+    void runBatchFolder();
+    void appendBatchResult(QString, QString, double, qulonglong);
     void generateSudoku();
     void checkSudoku();
     void solveSudoku();
-    void receiveSudokuAndSolution(QString, QString);
+    void showDiggingProgress(unsigned, double);
+    void receiveSudokuAndSolution(QString, QString, QString);
+    void solveSudokuFile();
+    void receiveSudokuFileResult(QString);
+    void updateJobStatus();
+    void cancelJobs();
 
 private:
     Ui::MainWindow *ui;
     QString sudokuString;
     QString solutionString;
+    unsigned sudokuSeed;
+
+    //results waiting to be appended to the text browser piece by piece
+    QStringList pendingResults;
+    int pendingResultPosition;
+
+    //every solver and generator job runs on the shared scheduler
+    JobScheduler *scheduler;
+
+    //batch files are handed to the scheduler as earlier ones finish,
+    //at most as many at once as the worker spin box allows
+    QStringList pendingBatchFileNames;
+    CNFSolverJob::Options batchOptions;
+    unsigned batchFileNum;
+    unsigned batchSubmittedNum;
+    unsigned batchDoneNum;
+    unsigned batchSatisfiedNum;
+    unsigned batchUnsatisfiedNum;
+
+    CNFSolverJob::Options getSolverOptions() const;
+    void startBatch(const QStringList &);
+    void submitBatchFiles();
+    void updateBatchSummary();
 };
 
 #endif // MAINWINDOW_H
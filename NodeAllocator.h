@@ -0,0 +1,197 @@
+#ifndef NODEALLOCATOR_H
+#define NODEALLOCATOR_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+//allocator policies used by List to get memory for its nodes
+
+//one global allocator call for every node
+struct NewDeleteNodeAllocator {
+
+    template <typename Node>
+    static void *allocate() {
+        return ::operator new(sizeof(Node));
+    }
+
+    template <typename Node>
+    static void deallocate(void *node) {
+        ::operator delete(node);
+    }
+};
+
+//fixed-size slots recycled through a thread-local free list
+//slots are carved from slabs of about 64KB, so refilling is the only slow path
+//nodes may be freed by another thread than the one that allocated them,
+//a full free list of a slab's worth of slots is put aside, and the list put aside before goes to the depot as one batch,
+//which the threads refill from before they take a new slab, so a thread holds only a few slabs' worth of free slots
+//slabs are never returned to the global allocator, but the pool stays at the peak number of live nodes plus what the threads hold,
+//also when one thread frees what another allocates
+template <std::size_t Size, std::size_t Alignment>
+class NodePool {
+
+public:
+
+    static void *allocate() {
+        Cache &localCache = cache();
+        if (localCache.freeList == nullptr) {
+            if (localCache.current != localCache.end)
+                return localCache.current++;
+            refill(localCache);
+        }
+        Slot *slot = localCache.freeList;
+        localCache.freeList = slot->next;
+        --localCache.freeNum;
+        return slot;
+    }
+
+    static void deallocate(void *node) {
+        Cache &localCache = cache();
+        Slot *slot = static_cast<Slot *>(node);
+        slot->next = localCache.freeList;
+        localCache.freeList = slot;
+        if (++localCache.freeNum >= localCache.freeLimit)
+            spill(localCache);
+    }
+
+private:
+
+    union Slot {
+        Slot *next;
+        alignas(Alignment) unsigned char storage[Size];
+    };
+
+    static const std::size_t slotsPerSlab = 65536 / sizeof(Slot) > 64 ? 65536 / sizeof(Slot) : 64;
+
+    struct Slab {
+        Slab *next;
+        Slot slots[slotsPerSlab];
+    };
+
+    //a list of free slots moved between a thread and the depot at once
+    struct Batch {
+        Slot *slots;
+        std::size_t slotNum;
+    };
+
+    //trivially destructible, so the hot path needs no thread_local guard
+    struct Cache {
+        Slot *freeList;
+        std::size_t freeNum; //slots in freeList
+        Batch spare; //a full list put aside, so a thread allocating and freeing around the limit does not lock the depot
+        Slot *current; //unused part of the last slab taken by this thread
+        Slot *end;
+        std::size_t freeLimit; //0 until the CacheOwner of this thread is constructed, then slotsPerSlab
+    };
+
+    //hands the free slots of an exiting thread over to the depot
+    struct CacheOwner {
+        ~CacheOwner() {
+            Cache &localCache = cache();
+            while (localCache.current != localCache.end) {
+                Slot *slot = localCache.current++;
+                slot->next = localCache.freeList;
+                localCache.freeList = slot;
+                ++localCache.freeNum;
+            }
+            std::lock_guard<std::mutex> lock(depotMutex);
+            if (localCache.freeList != nullptr)
+                depotBatches.push_back(Batch{localCache.freeList, localCache.freeNum});
+            if (localCache.spare.slots != nullptr)
+                depotBatches.push_back(localCache.spare);
+            localCache.freeList = nullptr;
+            localCache.freeNum = 0;
+            localCache.spare = Batch{nullptr, 0};
+        }
+    };
+
+    static std::mutex depotMutex;
+    static std::vector<Batch> depotBatches; //slots left by finished threads and by threads freeing more than they allocate
+    static Slab *slabs; //all slabs ever allocated
+
+    static Cache &cache() {
+        thread_local Cache localCache = {nullptr, 0, {nullptr, 0}, nullptr, nullptr, 0};
+        return localCache;
+    }
+
+    static void registerOwner(Cache &localCache) {
+        thread_local CacheOwner owner;
+        (void)owner;
+        localCache.freeLimit = slotsPerSlab;
+    }
+
+    //the full free list becomes the spare one, and an earlier spare list goes to the depot
+    static void spill(Cache &localCache) {
+        if (localCache.freeLimit == 0)
+            registerOwner(localCache);
+        if (localCache.freeNum < slotsPerSlab)
+            return;
+        if (localCache.spare.slots != nullptr) {
+            std::lock_guard<std::mutex> lock(depotMutex);
+            depotBatches.push_back(localCache.spare);
+        }
+        localCache.spare = Batch{localCache.freeList, localCache.freeNum};
+        localCache.freeList = nullptr;
+        localCache.freeNum = 0;
+    }
+
+    //leaves a nonempty free list, from the spare list, the depot or a new slab
+    static void refill(Cache &localCache) {
+        if (localCache.freeLimit == 0)
+            registerOwner(localCache);
+        Batch batch = localCache.spare;
+        localCache.spare = Batch{nullptr, 0};
+        if (batch.slots == nullptr) {
+            std::lock_guard<std::mutex> lock(depotMutex);
+            if (!depotBatches.empty()) {
+                batch = depotBatches.back();
+                depotBatches.pop_back();
+            }
+            else {
+                Slab *slab = static_cast<Slab *>(::operator new(sizeof(Slab)));
+                slab->next = slabs;
+                slabs = slab;
+                batch = Batch{slab->slots, 1};
+                slab->slots[0].next = nullptr;
+                localCache.current = slab->slots + 1;
+                localCache.end = slab->slots + slotsPerSlab;
+            }
+        }
+        localCache.freeList = batch.slots;
+        localCache.freeNum = batch.slotNum;
+    }
+};
+
+template <std::size_t Size, std::size_t Alignment>
+std::mutex NodePool<Size, Alignment>::depotMutex;
+
+template <std::size_t Size, std::size_t Alignment>
+std::vector<typename NodePool<Size, Alignment>::Batch> NodePool<Size, Alignment>::depotBatches;
+
+template <std::size_t Size, std::size_t Alignment>
+typename NodePool<Size, Alignment>::Slab *NodePool<Size, Alignment>::slabs = nullptr;
+
+//nodes of the same size share one pool, e.g. List<int> and List<unsigned>
+struct PooledNodeAllocator {
+
+    template <typename Node>
+    static void *allocate() {
+        return NodePool<sizeof(Node), alignof(Node)>::allocate();
+    }
+
+    template <typename Node>
+    static void deallocate(void *node) {
+        NodePool<sizeof(Node), alignof(Node)>::deallocate(node);
+    }
+};
+
+//define LIST_NEW_DELETE_NODES to go back to one allocation per node, e.g. for comparison
+#ifdef LIST_NEW_DELETE_NODES
+typedef NewDeleteNodeAllocator DefaultNodeAllocator;
+#else
+typedef PooledNodeAllocator DefaultNodeAllocator;
+#endif
+
+#endif // NODEALLOCATOR_H
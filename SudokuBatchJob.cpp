@@ -0,0 +1,52 @@
+#include "SudokuBatchJob.h"
+#include "SudokuBatchSolver.h"
+#include <sstream>
+#include <QFile>
+
+SudokuBatchJob::SudokuBatchJob(const QString &fileName, QObject *parent)
+    : QObject(parent),
+      fileName(fileName) {}
+
+void SudokuBatchJob::run(const JobScheduler::Job &job) {
+    if (job.isCanceled()) {
+        emit sendResult(fileName + " canceled.\n");
+        return;
+    }
+    QFile input(fileName);
+    if (!input.open(QIODevice::ReadOnly)) {
+        emit sendResult("Cannot open " + fileName + "!\n");
+        return;
+    }
+    QString solutionFileName = fileName + ".solution";
+    QFile output(solutionFileName);
+    if (!output.open(QIODevice::ReadWrite | QIODevice::Truncate) || !output.resize(input.size())) {
+        emit sendResult("Cannot write " + solutionFileName + "!\n");
+        return;
+    }
+
+    //the solutions replace the puzzles in place, so the output is exactly as large as the input
+    std::stringstream report;
+    report << fileName.toStdString() << " solved!" << std::endl;
+    unsigned lentWorkerNum = job.borrowWorkers(static_cast<unsigned>(-1));
+    SudokuBatchSolver solver(1 + lentWorkerNum);
+    solver.setStopFlag(&job.getCancelFlag());
+    if (input.size() > 0) {
+        const uchar *inputData = input.map(0, input.size());
+        uchar *outputData = output.map(0, output.size());
+        if (inputData == nullptr || outputData == nullptr) {
+            emit sendResult("Cannot map " + fileName + " into memory!\n");
+            return;
+        }
+        solver.solve(reinterpret_cast<const char *>(inputData), static_cast<std::size_t>(input.size()),
+                     reinterpret_cast<char *>(outputData));
+        output.unmap(outputData);
+        input.unmap(const_cast<uchar *>(inputData));
+    }
+    job.returnWorkers(lentWorkerNum);
+    solver.printStatistics(report);
+    if (solver.isStopped())
+        report << "Canceled, " << solutionFileName.toStdString() << " is incomplete." << std::endl;
+    else
+        report << "Solutions written to " << solutionFileName.toStdString() << std::endl;
+    emit sendResult(QString::fromStdString(report.str()));
+}
@@ -0,0 +1,25 @@
+#ifndef SUDOKUBATCHJOB_H
+#define SUDOKUBATCHJOB_H
+
+#include "JobScheduler.h"
+#include <QObject>
+#include <QString>
+
+//solves a file of Sudoku lines into <file>.solution, both files are memory mapped
+//the job solves on its own worker and on all the workers of the scheduler idle when it starts, which it borrows
+class SudokuBatchJob : public QObject {
+    Q_OBJECT
+
+public:
+    SudokuBatchJob(const QString &, QObject *parent = nullptr);
+
+    void run(const JobScheduler::Job &);
+
+signals:
+    void sendResult(QString);
+
+private:
+    QString fileName;
+};
+
+#endif // SUDOKUBATCHJOB_H
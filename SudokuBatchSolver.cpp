@@ -0,0 +1,305 @@
+#include "SudokuBatchSolver.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+//cells are numbered row by row from 0, units are the 9 rows, then the 9 columns, then the 9 blocks
+struct SudokuTables {
+    unsigned peers[81][20];
+    unsigned units[27][9];
+
+    SudokuTables() {
+        for (unsigned i = 0; i < 9; ++i) {
+            for (unsigned j = 0; j < 9; ++j) {
+                units[i][j] = i * 9 + j;
+                units[i + 9][j] = j * 9 + i;
+                units[i + 18][j] = (i / 3 * 3 + j / 3) * 9 + i % 3 * 3 + j % 3;
+            }
+        }
+        for (unsigned cell = 0; cell < 81; ++cell) {
+            unsigned peerNum = 0;
+            for (unsigned other = 0; other < 81; ++other) {
+                bool isSameRow = cell / 9 == other / 9;
+                bool isSameColumn = cell % 9 == other % 9;
+                bool isSameBlock = cell / 27 == other / 27 && cell % 9 / 3 == other % 9 / 3;
+                if (other != cell && (isSameRow || isSameColumn || isSameBlock))
+                    peers[cell][peerNum++] = other;
+            }
+        }
+    }
+};
+
+const SudokuTables tables;
+
+inline bool isSingle(std::uint16_t candidates) {
+    return (candidates & (candidates - 1)) == 0;
+}
+
+inline unsigned getDigit(std::uint16_t bit) {
+    unsigned digit = 1;
+    while (bit >>= 1)
+        ++digit;
+    return digit;
+}
+
+inline unsigned getCandidateNum(std::uint16_t candidates) {
+    unsigned candidateNum = 0;
+    for (; candidates != 0; candidates &= candidates - 1)
+        ++candidateNum;
+    return candidateNum;
+}
+
+}
+
+SudokuBatchSolver::SudokuBatchSolver(unsigned threadNum)
+    : threadNum(threadNum != 0 ? threadNum : std::max(1u, std::thread::hardware_concurrency())),
+      stopFlag(nullptr),
+      hasStopped(false) {}
+
+const SudokuBatchSolver::Statistics &SudokuBatchSolver::solve(const char *input, std::size_t size, char *output) {
+    TRACE_SCOPE("SudokuBatchSolver::solve");
+    auto solveBeginTime = std::chrono::steady_clock::now();
+    std::size_t blockNum = (size + blockSize - 1) / blockSize;
+    unsigned workerNum = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threadNum, blockNum)));
+    std::vector<WorkerInfo> workersInfo(workerNum);
+    std::atomic<std::size_t> nextBlock(0);
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < workerNum; ++i)
+        workers.emplace_back(&SudokuBatchSolver::solveBlocks, input, size, output, std::ref(nextBlock), stopFlag, std::ref(workersInfo[i]));
+    solveBlocks(input, size, output, nextBlock, stopFlag, workersInfo[0]);
+    for (std::thread &worker : workers)
+        worker.join();
+    hasStopped = false;
+
+    statistics = Statistics();
+    LatencyHistogram &latencies = workersInfo[0].latencies;
+    for (unsigned i = 0; i < workerNum; ++i) {
+        statistics.puzzleNum += workersInfo[i].puzzleNum;
+        statistics.solvedNum += workersInfo[i].solvedNum;
+        statistics.invalidLineNum += workersInfo[i].invalidLineNum;
+        hasStopped = hasStopped || workersInfo[i].hasStopped;
+        if (i != 0)
+            latencies.merge(workersInfo[i].latencies);
+    }
+    statistics.medianLatency = latencies.getPercentile(0.5);
+    statistics.p90Latency = latencies.getPercentile(0.9);
+    statistics.p99Latency = latencies.getPercentile(0.99);
+    statistics.maxLatency = latencies.maxLatency;
+    statistics.threadNum = workerNum;
+    statistics.solveTime = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                               std::chrono::steady_clock::now() - solveBeginTime).count());
+    return statistics;
+}
+
+void SudokuBatchSolver::printStatistics(std::ostream &os) const {
+    double seconds = statistics.solveTime / 1e9;
+    os << "Solved " << statistics.solvedNum << " of " << statistics.puzzleNum << " puzzles with "
+       << statistics.threadNum << " threads in " << seconds * 1000 << " ms" << std::endl;
+    if (seconds > 0)
+        os << "Throughput: " << static_cast<unsigned long long>(statistics.puzzleNum / seconds) << " puzzles/s" << std::endl;
+    os << "Latency: median " << statistics.medianLatency / 1000.0
+       << " us, p90 " << statistics.p90Latency / 1000.0
+       << " us, p99 " << statistics.p99Latency / 1000.0
+       << " us, max " << statistics.maxLatency / 1000.0 << " us" << std::endl;
+    if (statistics.invalidLineNum > 0)
+        os << statistics.invalidLineNum << " lines without 81 cells were copied unchanged." << std::endl;
+}
+
+void SudokuBatchSolver::setStopFlag(const std::atomic<bool> *flag) {
+    stopFlag = flag;
+}
+
+bool SudokuBatchSolver::isStopped() const {
+    return hasStopped;
+}
+
+const SudokuBatchSolver::Statistics &SudokuBatchSolver::getStatistics() const {
+    return statistics;
+}
+
+bool SudokuBatchSolver::solveCells(const char *cells, char *solution) {
+    Grid grid;
+    std::fill(grid.candidates, grid.candidates + 81, static_cast<std::uint16_t>(0x1ff));
+    std::fill(grid.isPlaced, grid.isPlaced + 81, false);
+    grid.placedNum = 0;
+    for (unsigned cell = 0; cell < 81; ++cell) {
+        if (cells[cell] >= '1' && cells[cell] <= '9' && !assign(grid, cell, static_cast<std::uint16_t>(1u << (cells[cell] - '1'))))
+            return false;
+    }
+    if (!search(grid))
+        return false;
+    for (unsigned cell = 0; cell < 81; ++cell)
+        solution[cell] = static_cast<char>('0' + getDigit(grid.candidates[cell]));
+    return true;
+}
+
+//every line is copied by the worker owning it, so no byte of the output is written twice
+void SudokuBatchSolver::solveBlocks(const char *input, std::size_t size, char *output,
+                                    std::atomic<std::size_t> &nextBlock, const std::atomic<bool> *stopFlag, WorkerInfo &workerInfo) {
+    for (std::size_t block = nextBlock++; block * blockSize < size; block = nextBlock++) {
+        if (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed)) {
+            workerInfo.hasStopped = true;
+            return;
+        }
+        std::size_t begin = block * blockSize;
+        std::size_t end = std::min(begin + blockSize, size);
+        //a line started in the previous block is not ours
+        if (begin > 0 && input[begin - 1] != '\n') {
+            const void *lineEnd = std::memchr(input + begin, '\n', size - begin);
+            begin = lineEnd != nullptr ? static_cast<const char *>(lineEnd) - input + 1 : size;
+        }
+        while (begin < end) {
+            const void *lineEnd = std::memchr(input + begin, '\n', size - begin);
+            std::size_t next = lineEnd != nullptr ? static_cast<const char *>(lineEnd) - input + 1 : size;
+            std::memcpy(output + begin, input + begin, next - begin);
+
+            std::size_t cellNum = 0;
+            while (cellNum < 81 && begin + cellNum < next) {
+                char cell = input[begin + cellNum];
+                if (cell != '.' && (cell < '0' || cell > '9'))
+                    break;
+                ++cellNum;
+            }
+            if (cellNum == 81) {
+                auto puzzleBeginTime = std::chrono::steady_clock::now();
+                workerInfo.solvedNum += solveCells(input + begin, output + begin);
+                workerInfo.latencies.add(static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                                             std::chrono::steady_clock::now() - puzzleBeginTime).count()));
+                ++workerInfo.puzzleNum;
+            }
+            else if (next - begin > 1 && !(next - begin == 2 && input[begin] == '\r'))
+                ++workerInfo.invalidLineNum; //empty lines are not counted
+            begin = next;
+        }
+    }
+}
+
+//put a digit into a cell and remove it from the peers, a peer left with one candidate is assigned in turn
+bool SudokuBatchSolver::assign(Grid &grid, unsigned cell, std::uint16_t bit) {
+    //a given may already be placed by the givens before it
+    if (grid.isPlaced[cell] || !(grid.candidates[cell] & bit))
+        return grid.candidates[cell] == bit;
+    grid.candidates[cell] = bit;
+    grid.isPlaced[cell] = true;
+    ++grid.placedNum;
+    for (unsigned peer : tables.peers[cell]) {
+        if (!(grid.candidates[peer] & bit))
+            continue;
+        if (grid.isPlaced[peer])
+            return false;
+        grid.candidates[peer] &= static_cast<std::uint16_t>(~bit);
+        if (grid.candidates[peer] == 0)
+            return false;
+        if (isSingle(grid.candidates[peer]) && !assign(grid, peer, grid.candidates[peer]))
+            return false;
+    }
+    return true;
+}
+
+//a digit missing from a unit is a conflict, a digit with a single place in a unit is put there
+bool SudokuBatchSolver::placeHiddenSingles(Grid &grid, bool &isChanged) {
+    isChanged = false;
+    for (const unsigned *unit : tables.units) {
+        std::uint16_t once = 0;
+        std::uint16_t twice = 0;
+        for (unsigned i = 0; i < 9; ++i) {
+            twice |= once & grid.candidates[unit[i]];
+            once |= grid.candidates[unit[i]];
+        }
+        if (once != 0x1ff)
+            return false;
+        std::uint16_t hiddenSingles = once & static_cast<std::uint16_t>(~twice);
+        for (unsigned i = 0; i < 9 && hiddenSingles != 0; ++i) {
+            std::uint16_t bit = grid.candidates[unit[i]] & hiddenSingles;
+            if (bit == 0)
+                continue;
+            hiddenSingles &= static_cast<std::uint16_t>(~bit);
+            if (grid.isPlaced[unit[i]])
+                continue;
+            //two hidden singles in one cell leave the other digit without a place
+            if (!isSingle(bit) || !assign(grid, unit[i], bit))
+                return false;
+            isChanged = true;
+        }
+    }
+    return true;
+}
+
+//branch on a cell with the fewest candidates, every branch works on its own copy of the grid
+bool SudokuBatchSolver::search(Grid &grid) {
+    bool isChanged = true;
+    while (isChanged) {
+        if (!placeHiddenSingles(grid, isChanged))
+            return false;
+    }
+    if (grid.placedNum == 81)
+        return true;
+
+    unsigned branchingCell = 81;
+    unsigned minCandidateNum = 10;
+    for (unsigned cell = 0; cell < 81 && minCandidateNum > 2; ++cell) {
+        if (grid.isPlaced[cell])
+            continue;
+        unsigned candidateNum = getCandidateNum(grid.candidates[cell]);
+        if (candidateNum < minCandidateNum) {
+            minCandidateNum = candidateNum;
+            branchingCell = cell;
+        }
+    }
+    for (std::uint16_t candidates = grid.candidates[branchingCell]; candidates != 0; candidates &= candidates - 1) {
+        Grid branch = grid;
+        if (assign(branch, branchingCell, candidates & static_cast<std::uint16_t>(-candidates)) && search(branch)) {
+            grid = branch;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SudokuBatchSolver::LatencyHistogram::add(unsigned long long latency) {
+    ++counts[getBucket(latency)];
+    ++totalNum;
+    maxLatency = std::max(maxLatency, latency);
+}
+
+void SudokuBatchSolver::LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (unsigned i = 0; i < bucketNum; ++i)
+        counts[i] += other.counts[i];
+    totalNum += other.totalNum;
+    maxLatency = std::max(maxLatency, other.maxLatency);
+}
+
+unsigned long long SudokuBatchSolver::LatencyHistogram::getPercentile(double fraction) const {
+    if (totalNum == 0)
+        return 0;
+    unsigned long long rank = static_cast<unsigned long long>(fraction * (totalNum - 1)) + 1;
+    unsigned long long countedNum = 0;
+    for (unsigned i = 0; i < bucketNum; ++i) {
+        countedNum += counts[i];
+        if (countedNum >= rank)
+            return std::min(getBucketLimit(i), maxLatency);
+    }
+    return maxLatency;
+}
+
+//latencies below 16 have a bucket each, above that the 4 bits after the highest one pick the bucket
+unsigned SudokuBatchSolver::LatencyHistogram::getBucket(unsigned long long latency) {
+    if (latency < 16)
+        return static_cast<unsigned>(latency);
+    unsigned highestBit = 4;
+    while (latency >> (highestBit + 1))
+        ++highestBit;
+    return (highestBit - 3) * 16 + static_cast<unsigned>((latency >> (highestBit - 4)) & 15);
+}
+
+unsigned long long SudokuBatchSolver::LatencyHistogram::getBucketLimit(unsigned bucket) {
+    if (bucket < 16)
+        return bucket;
+    unsigned highestBit = bucket / 16 + 3;
+    return ((16ULL + bucket % 16 + 1) << (highestBit - 4)) - 1;
+}
@@ -0,0 +1,102 @@
+#ifndef SUDOKUBATCHSOLVER_H
+#define SUDOKUBATCHSOLVER_H
+
+#include <iostream>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//solves text with one Sudoku per line on all the cores
+//a puzzle line starts with 81 cells, 1 to 9 for a given and 0 or . for a blank, anything after them is kept
+//every cell keeps a bit set of its candidates and the same exactly-one constraints as the CNF encoding are propagated:
+//a cell with one candidate removes it from its 20 peers, a digit with one place left in a unit is put there
+//the search state of a puzzle lives on the stack, so solving allocates nothing per puzzle
+class SudokuBatchSolver {
+
+public:
+
+    //times are in nanoseconds
+    struct Statistics {
+        unsigned long long puzzleNum;
+        unsigned long long solvedNum;
+        unsigned long long invalidLineNum; //lines without 81 cells, copied unchanged
+        unsigned long long solveTime; //wall clock time of the whole batch
+        unsigned long long medianLatency;
+        unsigned long long p90Latency;
+        unsigned long long p99Latency;
+        unsigned long long maxLatency;
+        unsigned threadNum;
+
+        Statistics()
+            : puzzleNum(0), solvedNum(0), invalidLineNum(0), solveTime(0),
+              medianLatency(0), p90Latency(0), p99Latency(0), maxLatency(0), threadNum(0) {}
+    };
+
+    explicit SudokuBatchSolver(unsigned threadNum = 0); //0 uses all the cores
+
+    //output has the size of input and gets every line of it with the cells of a solved puzzle filled in,
+    //a puzzle without solution is copied unchanged
+    const Statistics &solve(const char *, std::size_t, char *);
+    void setStopFlag(const std::atomic<bool> *); //the workers give up at the next block once the flag is set
+    bool isStopped() const; //the last solve gave up, the rest of the output is not written
+    void printStatistics(std::ostream &) const;
+    const Statistics &getStatistics() const;
+    static bool solveCells(const char *, char *); //81 cells in, 81 digits out
+
+    //disable all the unused functions
+    SudokuBatchSolver(const SudokuBatchSolver &) = delete;
+    SudokuBatchSolver(SudokuBatchSolver &&) = delete;
+    SudokuBatchSolver &operator=(const SudokuBatchSolver &) = delete;
+    SudokuBatchSolver &operator=(SudokuBatchSolver &&) = delete;
+
+private:
+
+    //bit d - 1 of a candidate set stands for digit d
+    struct Grid {
+        std::uint16_t candidates[81];
+        bool isPlaced[81];
+        unsigned placedNum;
+    };
+
+    //latencies counted in buckets of 1/16 of a power of two, so percentiles are within 6%
+    struct LatencyHistogram {
+        static const unsigned bucketNum = 64 * 16;
+
+        unsigned long long counts[bucketNum];
+        unsigned long long totalNum;
+        unsigned long long maxLatency;
+
+        LatencyHistogram() : counts{0}, totalNum(0), maxLatency(0) {}
+        void add(unsigned long long);
+        void merge(const LatencyHistogram &);
+        unsigned long long getPercentile(double) const;
+        static unsigned getBucket(unsigned long long);
+        static unsigned long long getBucketLimit(unsigned); //largest latency of a bucket
+    };
+
+    //what a worker thread collects, merged after all of them are done
+    struct WorkerInfo {
+        unsigned long long puzzleNum;
+        unsigned long long solvedNum;
+        unsigned long long invalidLineNum;
+        LatencyHistogram latencies;
+        bool hasStopped; //some blocks were left by this worker
+
+        WorkerInfo() : puzzleNum(0), solvedNum(0), invalidLineNum(0), hasStopped(false) {}
+    };
+
+    //lines are handed out in blocks of bytes, a line belongs to the block it starts in
+    static const std::size_t blockSize = 1 << 16;
+
+    unsigned threadNum;
+    Statistics statistics;
+    const std::atomic<bool> *stopFlag;
+    bool hasStopped;
+
+    static void solveBlocks(const char *, std::size_t, char *, std::atomic<std::size_t> &, const std::atomic<bool> *, WorkerInfo &);
+    static bool assign(Grid &, unsigned, std::uint16_t);
+    static bool placeHiddenSingles(Grid &, bool &);
+    static bool search(Grid &);
+};
+
+#endif // SUDOKUBATCHSOLVER_H
@@ -0,0 +1,264 @@
+#include "SudokuCache.h"
+#include "Trace.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+//a partial transformation, the rows before the current one and all the columns are chosen
+struct SearchState {
+    bool isTransposed;
+    unsigned char rows[9];
+    unsigned char columns[9];
+    unsigned char labels[10];
+    unsigned char nextLabel;
+    unsigned short usedRows;
+};
+
+inline unsigned getCell(const unsigned sudoku[][10], bool isTransposed, unsigned row, unsigned column) {
+    return isTransposed ? sudoku[column + 1][row + 1] : sudoku[row + 1][column + 1];
+}
+
+//digit of the form for a digit of the grid, a digit seen for the first time gets the next label
+inline unsigned char getLabel(unsigned digit, unsigned char *labels, unsigned char &nextLabel) {
+    if (digit != 0 && labels[digit] == 0)
+        labels[digit] = nextLabel++;
+    return labels[digit];
+}
+
+//the columns are chosen one by one for the first row, a stack at a time,
+//and a branch is cut as soon as its row gets larger than the best one
+void searchFirstRow(const unsigned sudoku[][10], SearchState &state, unsigned position, unsigned usedColumns,
+                    unsigned char *bestRow, std::vector<SearchState> &states) {
+    if (position == 9) {
+        states.push_back(state);
+        return;
+    }
+    unsigned firstColumn = position % 3 == 0 ? 0 : state.columns[position - 1] / 3 * 3;
+    unsigned lastColumn = position % 3 == 0 ? 9 : firstColumn + 3;
+    for (unsigned column = firstColumn; column < lastColumn; ++column) {
+        if ((usedColumns >> column) & 1 || (position % 3 == 0 && (usedColumns >> (column / 3 * 3)) & 7))
+            continue;
+        unsigned digit = getCell(sudoku, state.isTransposed, state.rows[0], column);
+        bool isNewLabel = digit != 0 && state.labels[digit] == 0;
+        unsigned char value = getLabel(digit, state.labels, state.nextLabel);
+        if (value <= bestRow[position]) {
+            if (value < bestRow[position]) {
+                bestRow[position] = value;
+                std::fill(bestRow + position + 1, bestRow + 9, static_cast<unsigned char>(10));
+                states.clear();
+            }
+            state.columns[position] = static_cast<unsigned char>(column);
+            searchFirstRow(sudoku, state, position + 1, usedColumns | (1u << column), bestRow, states);
+        }
+        if (isNewLabel) {
+            state.labels[digit] = 0;
+            --state.nextLabel;
+        }
+    }
+}
+
+}
+
+void SudokuCache::CanonicalForm::toCanonical(const unsigned sudoku[][10], char *canonicalCells) const {
+    for (unsigned i = 0; i < 9; ++i) {
+        for (unsigned j = 0; j < 9; ++j)
+            canonicalCells[i * 9 + j] = static_cast<char>('0' + labels[getCell(sudoku, isTransposed, rows[i], columns[j])]);
+    }
+}
+
+void SudokuCache::CanonicalForm::fromCanonical(const char *canonicalCells, unsigned sudoku[][10]) const {
+    unsigned digits[10] = {0};
+    for (unsigned digit = 1; digit <= 9; ++digit)
+        digits[labels[digit]] = digit;
+    for (unsigned i = 0; i < 9; ++i) {
+        for (unsigned j = 0; j < 9; ++j) {
+            unsigned digit = digits[canonicalCells[i * 9 + j] - '0'];
+            if (isTransposed)
+                sudoku[columns[j] + 1][rows[i] + 1] = digit;
+            else
+                sudoku[rows[i] + 1][columns[j] + 1] = digit;
+        }
+    }
+}
+
+SudokuCache::SudokuCache(std::size_t capacity)
+    : shardCapacity(std::max<std::size_t>(1, capacity / shardNum)) {}
+
+SudokuCache &SudokuCache::getInstance() {
+    static SudokuCache cache;
+    return cache;
+}
+
+//the form is built row by row, keeping every partial transformation whose rows so far are the smallest
+//the first row fixes the columns, so every later row only picks one of the rows left
+//a full first row ties for all the 1296 column orders, so the limit is above the 18 * 1296 of that case
+bool SudokuCache::canonicalize(const unsigned sudoku[][10], CanonicalForm &form) {
+    TRACE_SCOPE("SudokuCache::canonicalize");
+    thread_local std::vector<SearchState> states;
+    thread_local std::vector<SearchState> nextStates;
+    states.clear();
+
+    unsigned char bestRow[9];
+    std::fill(bestRow, bestRow + 9, static_cast<unsigned char>(10));
+    for (unsigned transposition = 0; transposition < 2; ++transposition) {
+        for (unsigned row = 0; row < 9; ++row) {
+            SearchState state;
+            state.isTransposed = transposition == 1;
+            state.rows[0] = static_cast<unsigned char>(row);
+            std::fill(state.labels, state.labels + 10, static_cast<unsigned char>(0));
+            state.nextLabel = 1;
+            state.usedRows = static_cast<unsigned short>(1u << row);
+            searchFirstRow(sudoku, state, 0, 0, bestRow, states);
+        }
+    }
+    for (unsigned j = 0; j < 9; ++j)
+        form.cells[j] = static_cast<char>('0' + bestRow[j]);
+
+    for (unsigned position = 1; position < 9; ++position) {
+        nextStates.clear();
+        std::fill(bestRow, bestRow + 9, static_cast<unsigned char>(10));
+        for (const SearchState &state : states) {
+            //a band is finished before the next one is started
+            unsigned firstRow = position % 3 == 0 ? 0 : state.rows[position - 1] / 3 * 3;
+            unsigned lastRow = position % 3 == 0 ? 9 : firstRow + 3;
+            for (unsigned row = firstRow; row < lastRow; ++row) {
+                if ((state.usedRows >> row) & 1 || (position % 3 == 0 && (state.usedRows >> (row / 3 * 3)) & 7))
+                    continue;
+                SearchState nextState = state;
+                bool isLess = false;
+                bool isGreater = false;
+                unsigned char values[9];
+                for (unsigned j = 0; j < 9 && !isGreater; ++j) {
+                    values[j] = getLabel(getCell(sudoku, state.isTransposed, row, state.columns[j]),
+                                         nextState.labels, nextState.nextLabel);
+                    if (!isLess) {
+                        isLess = values[j] < bestRow[j];
+                        isGreater = values[j] > bestRow[j];
+                    }
+                }
+                if (isGreater)
+                    continue;
+                if (isLess) {
+                    std::copy(values, values + 9, bestRow);
+                    nextStates.clear();
+                }
+                nextState.rows[position] = static_cast<unsigned char>(row);
+                nextState.usedRows = static_cast<unsigned short>(nextState.usedRows | (1u << row));
+                nextStates.push_back(nextState);
+            }
+            if (nextStates.size() > maxStateNum)
+                return false;
+        }
+        states.swap(nextStates);
+        for (unsigned j = 0; j < 9; ++j)
+            form.cells[position * 9 + j] = static_cast<char>('0' + bestRow[j]);
+    }
+
+    //every state left gives the form, the digits missing from the grid take the labels left in order
+    const SearchState &state = states.front();
+    form.isTransposed = state.isTransposed;
+    std::copy(state.rows, state.rows + 9, form.rows);
+    std::copy(state.columns, state.columns + 9, form.columns);
+    std::copy(state.labels, state.labels + 10, form.labels);
+    unsigned char nextLabel = state.nextLabel;
+    for (unsigned digit = 1; digit <= 9; ++digit) {
+        if (form.labels[digit] == 0)
+            form.labels[digit] = nextLabel++;
+    }
+    return true;
+}
+
+bool SudokuCache::find(const CanonicalForm &form, Result &result) {
+    Shard &shard = shards[getHash(form.cells) % shardNum];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto position = shard.positions.find(std::string(form.cells, 81));
+    if (position == shard.positions.end()) {
+        ++shard.missNum;
+        return false;
+    }
+    shard.entries.splice(shard.entries.begin(), shard.entries, position->second);
+    result = position->second->result;
+    ++shard.hitNum;
+    return true;
+}
+
+void SudokuCache::storeSolution(const CanonicalForm &form, const unsigned solution[][10]) {
+    Shard &shard = shards[getHash(form.cells) % shardNum];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Result &result = findOrAdd(shard, std::string(form.cells, 81));
+    if (solution != nullptr) {
+        result.isSolved = true;
+        form.toCanonical(solution, result.solution);
+    }
+    else
+        result.isUnsolvable = true;
+}
+
+void SudokuCache::storeUniqueness(const CanonicalForm &form, bool isUnique) {
+    Shard &shard = shards[getHash(form.cells) % shardNum];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    findOrAdd(shard, std::string(form.cells, 81)).uniqueness = isUnique ? Unique : NotUnique;
+}
+
+void SudokuCache::clear() {
+    for (Shard &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.positions.clear();
+        shard.hitNum = 0;
+        shard.missNum = 0;
+    }
+}
+
+std::size_t SudokuCache::getSize() const {
+    std::size_t size = 0;
+    for (const Shard &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size += shard.positions.size();
+    }
+    return size;
+}
+
+unsigned long long SudokuCache::getHitNum() const {
+    unsigned long long hitNum = 0;
+    for (const Shard &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        hitNum += shard.hitNum;
+    }
+    return hitNum;
+}
+
+unsigned long long SudokuCache::getMissNum() const {
+    unsigned long long missNum = 0;
+    for (const Shard &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        missNum += shard.missNum;
+    }
+    return missNum;
+}
+
+//FNV-1a over the 81 cells, the map of a shard hashes the key again on its own
+std::size_t SudokuCache::getHash(const char *cells) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned i = 0; i < 81; ++i) {
+        hash ^= static_cast<unsigned char>(cells[i]);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+SudokuCache::Result &SudokuCache::findOrAdd(Shard &shard, const std::string &key) {
+    auto position = shard.positions.find(key);
+    if (position != shard.positions.end()) {
+        shard.entries.splice(shard.entries.begin(), shard.entries, position->second);
+        return position->second->result;
+    }
+    shard.entries.push_front(Entry{key, Result()});
+    shard.positions.emplace(key, shard.entries.begin());
+    if (shard.entries.size() > shardCapacity) {
+        shard.positions.erase(shard.entries.back().key);
+        shard.entries.pop_back();
+    }
+    return shard.entries.front().result;
+}
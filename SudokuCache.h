@@ -0,0 +1,94 @@
+#ifndef SUDOKUCACHE_H
+#define SUDOKUCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+//results of Sudoku searches shared by all the threads, keyed on the canonical form of the grid
+//grids equal up to digit relabeling, row swaps within a band, column swaps within a stack,
+//band swaps, stack swaps and transposition have the same canonical form,
+//so a result found for one of them is mapped back to any other
+//the entries are spread over shards with a lock and an LRU list each, the least recently used entry is evicted
+class SudokuCache {
+
+public:
+
+    //how a grid becomes its canonical form, cell (i, j) of the form is the relabeled cell (rows[i], columns[j])
+    //of the grid or of its transposition, rows and columns from 0, digits from 1 and 0 for blanks
+    struct CanonicalForm {
+        char cells[81]; //'0' to '9' row by row
+        bool isTransposed;
+        unsigned char rows[9];
+        unsigned char columns[9];
+        unsigned char labels[10]; //digit of the form for every digit of the grid, a bijection on 1 to 9
+
+        void toCanonical(const unsigned [][10], char *) const; //any grid, such as a solution, in the same frame
+        void fromCanonical(const char *, unsigned [][10]) const;
+    };
+
+    enum Uniqueness {
+        Unknown,
+        Unique,
+        NotUnique
+    };
+
+    //what is known of a canonical form
+    struct Result {
+        bool isSolved; //a solution is stored
+        bool isUnsolvable;
+        Uniqueness uniqueness;
+        char solution[81]; //in the frame of the form
+
+        Result() : isSolved(false), isUnsolvable(false), uniqueness(Unknown), solution{0} {}
+    };
+
+    explicit SudokuCache(std::size_t capacity = 1 << 15);
+    static SudokuCache &getInstance(); //the cache used by the solver and the generator
+    //minimal lexicographic form, false when too many transformations tie on a sparse grid
+    static bool canonicalize(const unsigned [][10], CanonicalForm &);
+    bool find(const CanonicalForm &, Result &);
+    void storeSolution(const CanonicalForm &, const unsigned [][10]); //nullptr for no solution
+    void storeUniqueness(const CanonicalForm &, bool);
+    void clear(); //drop all the entries and reset the counters
+    std::size_t getSize() const;
+    unsigned long long getHitNum() const;
+    unsigned long long getMissNum() const;
+
+    //disable all the unused functions
+    SudokuCache(const SudokuCache &) = delete;
+    SudokuCache(SudokuCache &&) = delete;
+    SudokuCache &operator=(const SudokuCache &) = delete;
+    SudokuCache &operator=(SudokuCache &&) = delete;
+
+private:
+
+    static const unsigned shardNum = 16;
+    static const std::size_t maxStateNum = 1 << 15; //partial transformations kept by canonicalize
+
+    struct Entry {
+        std::string key;
+        Result result;
+    };
+
+    //front of the list is the most recently used entry
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> positions;
+        unsigned long long hitNum;
+        unsigned long long missNum;
+
+        Shard() : hitNum(0), missNum(0) {}
+    };
+
+    std::size_t shardCapacity;
+    Shard shards[shardNum];
+
+    static std::size_t getHash(const char *);
+    Result &findOrAdd(Shard &, const std::string &); //call it with the lock of the shard held
+};
+
+#endif // SUDOKUCACHE_H
@@ -0,0 +1,433 @@
+#include "SudokuGenerator.h"
+#include "CNFSolver.h"
+#include "SudokuCache.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    //a search on one order gives up after this many checks, and a solution after this many orders without fewer givens
+    const unsigned long long attemptCheckNum = 200;
+    const unsigned solutionAttemptNum = 8;
+    const std::size_t maxVerdictNum = 16; //kept for every cell, the oldest one is dropped
+
+}
+
+//the search state of digWithBacktracking, cells are numbered row by row from 0
+//every verdict found on the current solution is kept for its cell: digging a cell that failed still fails
+//with more holes and one that succeeded still succeeds with fewer, as digging more cells only adds solutions
+struct SudokuGenerator::DiggingSearch {
+    std::vector<std::bitset<81>> failedHoles[81];
+    std::vector<std::bitset<81>> uniqueHoles[81];
+    unsigned order[81]; //of the current attempt
+    std::bitset<81> holes;
+    unsigned targetHoleNum;
+    unsigned bestHoleNum; //on any solution, a branch that cannot dig more is cut
+    unsigned bestSudoku[10][10];
+    unsigned bestSolution[10][10];
+    unsigned long long attemptCheckEnd; //checkNum where the current attempt gives up
+    const std::atomic<bool> *stopFlag;
+    bool isStopped;
+};
+
+SudokuGenerator::SudokuGenerator(unsigned seed)
+    : randomGenerator(seed),
+      sudoku{{0}},
+      solution{{0}},
+      rowFlag{{false}},
+      colFlag{{false}},
+      blockFlag{{false}},
+      threadNum(1),
+      diggingMode(InOrder),
+      checkBudget(5000),
+      checkNum(0),
+      minGivenCellNum(82) {}
+
+//the shown seed can be typed into the seed spin box, which takes 1 to the largest int and has 0 for a random seed
+unsigned SudokuGenerator::getRandomSeed() {
+    unsigned long long ticks = static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return static_cast<unsigned>(ticks % std::numeric_limits<int>::max()) + 1;
+}
+
+void SudokuGenerator::setThreadNum(unsigned num) {
+    threadNum = num != 0 ? num : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void SudokuGenerator::setDiggingMode(DiggingMode mode) {
+    diggingMode = mode;
+}
+
+void SudokuGenerator::setCheckBudget(unsigned long long budget) {
+    checkBudget = budget;
+}
+
+void SudokuGenerator::setProgressCallback(ProgressCallback callback) {
+    progressCallback = std::move(callback);
+}
+
+bool SudokuGenerator::generate(unsigned givenCellNum, const std::atomic<bool> *stopFlag) {
+    generateBegin = std::chrono::steady_clock::now();
+    std::fill(reachTimes, reachTimes + 82, -1.0);
+    minGivenCellNum = 82;
+    checkNum = 0;
+
+    //Use Las Vegas Algorithm to generate a complete sudoku solution
+    while (!lasVegas(11)) {
+        if (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed))
+            return false;
+    }
+    memcpy(sudoku, solution, sizeof(solution));
+    reachGivenCellNum(81);
+
+    //dig holes to generate a sudoku
+    //digging from top to bottom and from left to right
+    unsigned blankCellNum = 81 - givenCellNum;
+    if (diggingMode == Backtracking)
+        return digWithBacktracking(blankCellNum, stopFlag);
+    return threadNum > 1 ? digInParallel(blankCellNum, stopFlag) : digInOrder(blankCellNum, stopFlag);
+}
+
+double SudokuGenerator::getReachTime(unsigned givenCellNum) const {
+    return givenCellNum <= 81 ? reachTimes[givenCellNum] : -1.0;
+}
+
+//digging only ever removes one given at a time, so every number between is reached as well
+void SudokuGenerator::reachGivenCellNum(unsigned givenCellNum) {
+    if (givenCellNum >= minGivenCellNum)
+        return;
+    using namespace std::chrono;
+    double time = duration_cast<duration<double, std::milli>>(steady_clock::now() - generateBegin).count();
+    for (unsigned i = givenCellNum; i < minGivenCellNum && i <= 81; ++i)
+        reachTimes[i] = time;
+    minGivenCellNum = givenCellNum;
+    if (progressCallback)
+        progressCallback(givenCellNum, time);
+}
+
+bool SudokuGenerator::digInOrder(unsigned blankCellNum, const std::atomic<bool> *stopFlag) {
+    for (unsigned i = 1; i <= 9; ++i) {
+        for (unsigned j = 1; j <= 9; ++j) {
+            if (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed))
+                return false;
+            if (blankCellNum > 0 && (++checkNum, isUnique(i, j))) {
+                sudoku[i][j] = 0;
+                --blankCellNum;
+                reachGivenCellNum(minGivenCellNum - 1);
+            }
+        }
+    }
+    return true;
+}
+
+//cells are numbered row by row from 0, the threadNum cells after the decided ones are checked at once
+//a check runs on the grid expected when its cell gets decided: every cell before it dug if its check found it unique,
+//or like the last decided cell while its check is still running
+//digging more cells only adds solutions, so a unique verdict still holds on a grid with fewer holes than it was
+//checked on and a verdict of several solutions on a grid with more, any other verdict is dropped and checked again
+//a guessed grid may already have several solutions, so only checks on the decided grid cache a unique verdict
+bool SudokuGenerator::digInParallel(unsigned blankCellNum, const std::atomic<bool> *stopFlag) {
+    enum CheckStatus {
+        Waiting,
+        Running,
+        Done
+    };
+
+    struct Speculation {
+        unsigned sudoku[10][10];
+        CheckStatus status;
+        bool isUnique;
+    };
+
+    Speculation speculations[81];
+    for (Speculation &speculation : speculations)
+        speculation.status = Waiting;
+    unsigned decidedCellNum = 0;
+    bool isLastDug = true;
+    bool isStopped = false;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    auto isFinished = [&] {
+        return decidedCellNum == 81 || blankCellNum == 0 || isStopped;
+    };
+    auto holds = [&](const Speculation &speculation) {
+        for (unsigned i = 1; i <= 9; ++i) {
+            for (unsigned j = 1; j <= 9; ++j) {
+                if (speculation.sudoku[i][j] == 0 && sudoku[i][j] != 0 && !speculation.isUnique)
+                    return false;
+                if (speculation.sudoku[i][j] != 0 && sudoku[i][j] == 0 && speculation.isUnique)
+                    return false;
+            }
+        }
+        return true;
+    };
+    auto work = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            unsigned cell = 81;
+            condition.wait(lock, [&] {
+                for (unsigned i = decidedCellNum; i < std::min(81u, decidedCellNum + threadNum) && cell == 81; ++i) {
+                    if (speculations[i].status == Waiting)
+                        cell = i;
+                }
+                return isFinished() || cell != 81;
+            });
+            if (isFinished())
+                return;
+            Speculation &speculation = speculations[cell];
+            memcpy(speculation.sudoku, sudoku, sizeof(sudoku));
+            for (unsigned i = decidedCellNum; i < cell; ++i) {
+                if (speculations[i].status == Done ? speculations[i].isUnique : isLastDug)
+                    speculation.sudoku[i / 9 + 1][i % 9 + 1] = 0;
+            }
+            speculation.status = Running;
+            bool isGridUnique = cell == decidedCellNum;
+            lock.unlock();
+            bool result = isUnique(speculation.sudoku, cell / 9 + 1, cell % 9 + 1, isGridUnique);
+            lock.lock();
+            speculation.isUnique = result;
+            speculation.status = Done;
+            ++checkNum;
+            isStopped = isStopped || (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed));
+
+            //decide the cells in order as long as their verdicts hold
+            while (!isFinished() && speculations[decidedCellNum].status == Done) {
+                Speculation &decided = speculations[decidedCellNum];
+                if (!holds(decided)) {
+                    decided.status = Waiting;
+                    break;
+                }
+                if (decided.isUnique) {
+                    sudoku[decidedCellNum / 9 + 1][decidedCellNum % 9 + 1] = 0;
+                    --blankCellNum;
+                    reachGivenCellNum(minGivenCellNum - 1);
+                }
+                isLastDug = decided.isUnique;
+                ++decidedCellNum;
+            }
+            condition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < std::min(threadNum, 81u); ++i)
+        workers.emplace_back(work);
+    work();
+    for (std::thread &worker : workers)
+        worker.join();
+    return !isStopped;
+}
+
+//every attempt digs the cells in a new random order, first each one it can, then backtracking over the digs,
+//and gives up after attemptCheckNum checks, the verdicts of earlier attempts on the same solution answer many checks
+//a new solution is found after solutionAttemptNum attempts without fewer givens, and once the budget is spent
+//the Sudoku with the fewest givens is kept
+bool SudokuGenerator::digWithBacktracking(unsigned blankCellNum, const std::atomic<bool> *stopFlag) {
+    TRACE_SCOPE("SudokuGenerator::digWithBacktracking");
+    std::unique_ptr<DiggingSearch> search(new DiggingSearch);
+    search->targetHoleNum = blankCellNum;
+    search->bestHoleNum = 0;
+    memcpy(search->bestSudoku, sudoku, sizeof(sudoku));
+    memcpy(search->bestSolution, solution, sizeof(solution));
+    search->stopFlag = stopFlag;
+    search->isStopped = false;
+    for (unsigned i = 0; i < 81; ++i)
+        search->order[i] = i;
+
+    unsigned failedAttemptNum = 0;
+    while (search->bestHoleNum < blankCellNum && checkNum < checkBudget && !search->isStopped) {
+        if (failedAttemptNum == solutionAttemptNum) {
+            while (!lasVegas(11)) {
+                if (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed))
+                    return false;
+            }
+            for (unsigned i = 0; i < 81; ++i) {
+                search->failedHoles[i].clear();
+                search->uniqueHoles[i].clear();
+            }
+            failedAttemptNum = 0;
+        }
+        //mt19937 with the plain modulo, the same order with every standard library
+        for (unsigned i = 80; i > 0; --i)
+            std::swap(search->order[i], search->order[randomGenerator() % (i + 1)]);
+        memcpy(sudoku, solution, sizeof(solution));
+        search->holes.reset();
+        search->attemptCheckEnd = checkNum + attemptCheckNum;
+        unsigned bestHoleNum = search->bestHoleNum;
+        digFrom(*search, 0);
+        failedAttemptNum = search->bestHoleNum > bestHoleNum ? 0 : failedAttemptNum + 1;
+    }
+    if (search->isStopped)
+        return false;
+    memcpy(sudoku, search->bestSudoku, sizeof(sudoku));
+    memcpy(solution, search->bestSolution, sizeof(solution));
+    return true;
+}
+
+//the cells from position on are dug or kept in the order of the attempt, digging first
+bool SudokuGenerator::digFrom(DiggingSearch &search, unsigned position) {
+    unsigned holeNum = static_cast<unsigned>(search.holes.count());
+    if (holeNum > search.bestHoleNum) {
+        search.bestHoleNum = holeNum;
+        memcpy(search.bestSudoku, sudoku, sizeof(sudoku));
+        memcpy(search.bestSolution, solution, sizeof(solution));
+        reachGivenCellNum(81 - holeNum);
+        if (holeNum >= search.targetHoleNum)
+            return true;
+    }
+    for (unsigned i = position; i < 81; ++i) {
+        if (search.stopFlag != nullptr && search.stopFlag->load(std::memory_order_relaxed))
+            search.isStopped = true;
+        if (search.isStopped || checkNum >= checkBudget || checkNum >= search.attemptCheckEnd)
+            return true;
+        //cut once the cells left that may still be dug cannot give more holes than the best Sudoku
+        unsigned maxHoleNum = holeNum;
+        for (unsigned j = i; j < 81; ++j)
+            maxHoleNum += !isKnownUndiggable(search, search.order[j]);
+        if (maxHoleNum <= search.bestHoleNum)
+            return false;
+        unsigned cell = search.order[i];
+        if (isDiggable(search, cell)) {
+            unsigned &number = sudoku[cell / 9 + 1][cell % 9 + 1];
+            number = 0;
+            search.holes.set(cell);
+            if (digFrom(search, i + 1))
+                return true;
+            search.holes.reset(cell);
+            number = solution[cell / 9 + 1][cell % 9 + 1];
+        }
+    }
+    return false;
+}
+
+bool SudokuGenerator::isKnownUndiggable(const DiggingSearch &search, unsigned cell) const {
+    for (const std::bitset<81> &failedHoles : search.failedHoles[cell]) {
+        if ((failedHoles & ~search.holes).none())
+            return true;
+    }
+    return false;
+}
+
+bool SudokuGenerator::isDiggable(DiggingSearch &search, unsigned cell) {
+    if (isKnownUndiggable(search, cell))
+        return false;
+    for (const std::bitset<81> &uniqueHoles : search.uniqueHoles[cell]) {
+        if ((search.holes & ~uniqueHoles).none())
+            return true;
+    }
+    ++checkNum;
+    bool result = isUnique(sudoku, cell / 9 + 1, cell % 9 + 1);
+    //only the most general verdicts are kept, the fewest holes for a failure and the most for a success
+    std::vector<std::bitset<81>> &verdicts = result ? search.uniqueHoles[cell] : search.failedHoles[cell];
+    verdicts.erase(std::remove_if(verdicts.begin(), verdicts.end(), [&](const std::bitset<81> &holes) {
+        return result ? (holes & ~search.holes).none() : (search.holes & ~holes).none();
+    }), verdicts.end());
+    if (verdicts.size() == maxVerdictNum)
+        verdicts.erase(verdicts.begin());
+    verdicts.push_back(search.holes);
+    return result;
+}
+
+void SudokuGenerator::getSudoku(unsigned grid[][10]) const {
+    memcpy(grid, sudoku, sizeof(sudoku));
+}
+
+void SudokuGenerator::getSolution(unsigned grid[][10]) const {
+    memcpy(grid, solution, sizeof(solution));
+}
+
+inline unsigned SudokuGenerator::getBlockIndex(unsigned i, unsigned j) {
+    return (i - 1) / 3 * 3 + (j - 1) / 3 + 1;
+}
+
+inline unsigned SudokuGenerator::rollDice() {
+    return static_cast<unsigned>(randomGenerator() % 9) + 1;
+}
+
+bool SudokuGenerator::lasVegas(unsigned n) {
+    TRACE_SCOPE("SudokuGenerator::lasVegas");
+    //init
+    unsigned i, j;
+    for (i = 1; i <= 9; ++i) {
+        for (j = 1; j <= 9; ++j) {
+            solution[i][j] = 0;
+            rowFlag[i][j] = false;
+            colFlag[i][j] = false;
+            blockFlag[i][j] = false;
+        }
+    }
+
+    //fill cells with random numbers
+    while (n > 0) {
+        i = rollDice();
+        j = rollDice();
+        if (solution[i][j] == 0) {
+            unsigned k = getBlockIndex(i, j);
+            unsigned value = rollDice();
+            if (!rowFlag[i][value] && !colFlag[j][value] && !blockFlag[k][value]) {
+                solution[i][j] = value;
+                rowFlag[i][value] = true;
+                colFlag[j][value] = true;
+                blockFlag[k][value] = true;
+                --n;
+            }
+        }
+    }
+
+    //check and generate a complete sudoku solution, return false if it fails
+    return CNFSolver::solveSudoku(solution);
+}
+
+bool SudokuGenerator::isUnique(unsigned i, unsigned j) const {
+    //the first cell must be unique
+    if (i == 0 && j == 0)
+        return true;
+    return isUnique(sudoku, i, j);
+}
+
+bool SudokuGenerator::isUnique(const unsigned grid[][10], unsigned i, unsigned j, bool isGridUnique) {
+    TRACE_SCOPE("SudokuGenerator::isUnique");
+    //equivalent puzzles share the verdict through the cache
+    unsigned dugSudoku[10][10];
+    memcpy(dugSudoku, grid, sizeof(dugSudoku));
+    dugSudoku[i][j] = 0;
+    SudokuCache &cache = SudokuCache::getInstance();
+    SudokuCache::CanonicalForm form;
+    SudokuCache::Result result;
+    bool isCached = SudokuCache::canonicalize(dugSudoku, form);
+    if (isCached && cache.find(form, result) && result.uniqueness != SudokuCache::Unknown)
+        return result.uniqueness == SudokuCache::Unique;
+
+    //numbers already given in the row, column or block of the cell cannot replace its number
+    unsigned k = getBlockIndex(i, j);
+    bool isGiven[10] = {false};
+    for (unsigned l = 1; l <= 9; ++l) {
+        isGiven[dugSudoku[i][l]] = true;
+        isGiven[dugSudoku[l][j]] = true;
+        isGiven[dugSudoku[(k - 1) / 3 * 3 + (l - 1) / 3 + 1][(k - 1) % 3 * 3 + (l - 1) % 3 + 1]] = true;
+    }
+
+    //suppose we dig this cell
+    for (unsigned num = 1; num <= 9; ++num)
+        if (grid[i][j] != num && !isGiven[num]) {
+            //change for another number and check if there exist another solution
+            dugSudoku[i][j] = num;
+            if (CNFSolver(dugSudoku).isSatisfied()) {
+                if (isCached)
+                    cache.storeUniqueness(form, false);
+                return false;
+            }
+        }
+    //after trying all the other numbers, it turns out to be unique, if the grid was
+    if (isCached && isGridUnique)
+        cache.storeUniqueness(form, true);
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef SUDOKUGENERATOR_H
+#define SUDOKUGENERATOR_H
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <functional>
+#include <random>
+
+//generation of a Sudoku with a unique solution, the same seed and number of given cells give the same Sudoku
+//a complete solution is found from a few random givens, then holes are dug while the solution stays unique
+//with more than one thread the next cells are checked at once, each on the grid it is expected to be dug from,
+//a check whose expectation turned out wrong is dropped unless its verdict holds anyway, so the Sudoku is the same
+//digging in order stops at the first grid where no cell can be dug, often well above 20 given cells,
+//backtracking searches random orders instead and undoes digs until the number of given cells is reached
+class SudokuGenerator {
+
+public:
+
+    enum DiggingMode {
+        InOrder, //row by row, every cell once
+        Backtracking //random orders with restarts, on one thread, settles for the fewest givens found within the budget
+    };
+
+    //the number of given cells first reached and the milliseconds since generate began
+    using ProgressCallback = std::function<void(unsigned, double)>;
+
+    explicit SudokuGenerator(unsigned seed);
+    static unsigned getRandomSeed(); //from the clock, for a different Sudoku every time, 1 to the largest int
+    void setThreadNum(unsigned); //cells checked at once while digging, 0 for all the cores, 1 by default
+    void setDiggingMode(DiggingMode); //InOrder by default
+    void setCheckBudget(unsigned long long); //uniqueness checks a backtracking generate may run
+    void setProgressCallback(ProgressCallback);
+    bool generate(unsigned givenCellNum, const std::atomic<bool> *stopFlag = nullptr); //false once the flag is set
+    double getReachTime(unsigned) const; //milliseconds the last generate took to reach the number of given cells, negative if never
+    unsigned long long getCheckNum() const; //uniqueness checks of the last generate, the ones answered by earlier verdicts excluded
+    bool lasVegas(unsigned); //random givens solved to a complete solution, false if they have none
+    bool isUnique(unsigned, unsigned) const; //whether the solution stays unique after digging the cell
+    void getSudoku(unsigned [][10]) const;
+    void getSolution(unsigned [][10]) const;
+
+    //disable all the unused functions
+    SudokuGenerator(const SudokuGenerator &) = delete;
+    SudokuGenerator(SudokuGenerator &&) = delete;
+    SudokuGenerator &operator=(const SudokuGenerator &) = delete;
+    SudokuGenerator &operator=(SudokuGenerator &&) = delete;
+
+private:
+
+    //mt19937 and the plain modulo below give the same numbers with every standard library
+    std::mt19937 randomGenerator;
+    unsigned sudoku[10][10];
+    unsigned solution[10][10];
+    bool rowFlag[10][10];
+    bool colFlag[10][10];
+    bool blockFlag[10][10];
+    unsigned threadNum;
+    DiggingMode diggingMode;
+    unsigned long long checkBudget;
+    unsigned long long checkNum;
+    ProgressCallback progressCallback;
+    std::chrono::steady_clock::time_point generateBegin;
+    double reachTimes[82]; //array size decided by the number of cells, indexed by the number of given cells
+    unsigned minGivenCellNum; //fewest given cells reached so far
+
+    struct DiggingSearch;
+
+    static unsigned getBlockIndex(unsigned, unsigned);
+    //the same for any grid with this solution, only proves the dug grid unique when the grid itself is,
+    //so a unique verdict is cached only then
+    static bool isUnique(const unsigned [][10], unsigned, unsigned, bool isGridUnique = true);
+    unsigned rollDice(); //from 1 to 9
+    void reachGivenCellNum(unsigned);
+    bool digInOrder(unsigned, const std::atomic<bool> *);
+    bool digInParallel(unsigned, const std::atomic<bool> *);
+    bool digWithBacktracking(unsigned, const std::atomic<bool> *);
+    bool digFrom(DiggingSearch &, unsigned); //true once the search is over
+    bool isDiggable(DiggingSearch &, unsigned);
+    bool isKnownUndiggable(const DiggingSearch &, unsigned) const;
+};
+
+inline unsigned long long SudokuGenerator::getCheckNum() const {
+    return checkNum;
+}
+
+#endif // SUDOKUGENERATOR_H
@@ -0,0 +1,44 @@
+#include "SudokuGeneratorJob.h"
+
+SudokuGeneratorJob::SudokuGeneratorJob(unsigned givenCellNum, unsigned seed, unsigned threadNum,
+                                             SudokuGenerator::DiggingMode diggingMode, QObject *parent)
+    : QObject(parent),
+      givenCellNum(givenCellNum),
+      seed(seed),
+      threadNum(threadNum),
+      diggingMode(diggingMode) {}
+
+//the digging threads other than the one of the job run on workers lent by the scheduler
+void SudokuGeneratorJob::run(const JobScheduler::Job &job) {
+    unsigned lentWorkerNum = job.borrowWorkers(threadNum != 0 ? threadNum - 1 : static_cast<unsigned>(-1));
+    SudokuGenerator generator(seed);
+    generator.setThreadNum(1 + lentWorkerNum);
+    generator.setDiggingMode(diggingMode);
+    generator.setProgressCallback([this](unsigned givenCellNum, double time) {
+        emit sendProgress(givenCellNum, time);
+    });
+    bool isGenerated = generator.generate(givenCellNum, &job.getCancelFlag());
+    job.returnWorkers(lentWorkerNum);
+    if (!isGenerated) {
+        emit sendSudokuAndSolution(QString(), QString(), QString());
+        return;
+    }
+    unsigned sudoku[10][10];
+    unsigned solution[10][10];
+    generator.getSudoku(sudoku);
+    generator.getSolution(solution);
+    QString sudokuString, solutionString;
+    for (unsigned i = 1; i <= 9; ++i) {
+        for (unsigned j = 1; j <= 9; ++j) {
+            sudokuString.append(QString::number(sudoku[i][j]));
+            solutionString.append(QString::number(solution[i][j]));
+        }
+    }
+    //eight numbers of given cells a line
+    QString reachTimeString = QString("%1 uniqueness checks, milliseconds to reach the given cells:").arg(generator.getCheckNum());
+    for (unsigned i = 81; i >= 17 && generator.getReachTime(i) >= 0; --i) {
+        reachTimeString.append((81 - i) % 8 == 0 ? "\n" : ", ");
+        reachTimeString.append(QString("%1: %2").arg(i).arg(generator.getReachTime(i), 0, 'f', 1));
+    }
+    emit sendSudokuAndSolution(sudokuString, solutionString, reachTimeString);
+}
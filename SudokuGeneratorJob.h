@@ -0,0 +1,31 @@
+#ifndef SUDOKUGENERATORJOB_H
+#define SUDOKUGENERATORJOB_H
+
+#include "JobScheduler.h"
+#include "SudokuGenerator.h"
+#include <QObject>
+#include <QString>
+
+//generation of a Sudoku with a unique solution, run as a job of the scheduler
+class SudokuGeneratorJob : public QObject {
+    Q_OBJECT
+
+public:
+    SudokuGeneratorJob(unsigned, unsigned seed, unsigned threadNum = 1, //threadNum 0 for all the idle workers
+                          SudokuGenerator::DiggingMode diggingMode = SudokuGenerator::InOrder, QObject *parent = nullptr);
+
+    void run(const JobScheduler::Job &);
+
+signals:
+    //both empty when the job is canceled, otherwise followed by the time taken to reach every number of given cells
+    void sendSudokuAndSolution(QString, QString, QString);
+    void sendProgress(unsigned, double); //fewest given cells so far and milliseconds since the start
+
+private:
+    const unsigned givenCellNum;
+    const unsigned seed;
+    const unsigned threadNum;
+    const SudokuGenerator::DiggingMode diggingMode;
+};
+
+#endif // SUDOKUGENERATORJOB_H
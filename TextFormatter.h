@@ -0,0 +1,82 @@
+#ifndef TEXTFORMATTER_H
+#define TEXTFORMATTER_H
+
+#include <iostream>
+#include <cstddef>
+
+//fast integer formatting for large outputs such as models
+//text is built in a fixed buffer that is reused after every flush, so the stream sees a few large writes
+class TextFormatter {
+
+public:
+
+    explicit TextFormatter(std::ostream &output) : output(output), position(0) {}
+    ~TextFormatter() {
+        flush();
+    }
+
+    void put(char);
+    void putUnsigned(unsigned);
+    void putInteger(int);
+    void flush();
+
+    //disable all the unused functions
+    TextFormatter(const TextFormatter &) = delete;
+    TextFormatter &operator=(const TextFormatter &) = delete;
+
+private:
+
+    static const std::size_t capacity = 1 << 16;
+
+    std::ostream &output;
+    std::size_t position;
+    char buffer[capacity];
+};
+
+inline void TextFormatter::put(char character) {
+    if (position == capacity)
+        flush();
+    buffer[position++] = character;
+}
+
+inline void TextFormatter::putUnsigned(unsigned value) {
+    static const char digitPairs[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+    //an unsigned has at most 10 digits
+    if (capacity - position < 10)
+        flush();
+    char digits[10];
+    int digitNum = 10;
+    while (value >= 100) {
+        unsigned pair = value % 100 * 2;
+        value /= 100;
+        digits[--digitNum] = digitPairs[pair + 1];
+        digits[--digitNum] = digitPairs[pair];
+    }
+    if (value >= 10) {
+        digits[--digitNum] = digitPairs[value * 2 + 1];
+        digits[--digitNum] = digitPairs[value * 2];
+    }
+    else
+        digits[--digitNum] = static_cast<char>('0' + value);
+    while (digitNum < 10)
+        buffer[position++] = digits[digitNum++];
+}
+
+inline void TextFormatter::putInteger(int value) {
+    if (value < 0) {
+        put('-');
+        putUnsigned(0u - static_cast<unsigned>(value));
+    }
+    else
+        putUnsigned(static_cast<unsigned>(value));
+}
+
+inline void TextFormatter::flush() {
+    output.write(buffer, static_cast<std::streamsize>(position));
+    position = 0;
+}
+
+#endif // TEXTFORMATTER_H
@@ -0,0 +1,94 @@
+#include "Trace.h"
+
+#ifdef SOLVER_TRACING
+
+#include <chrono>
+#include <iomanip>
+
+namespace {
+    const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+}
+
+std::atomic<bool> Tracer::enabled(false);
+std::atomic<Tracer::Buffer *> Tracer::buffers(nullptr);
+std::atomic<unsigned> Tracer::threadNum(0);
+std::mutex Tracer::freeBufferMutex;
+Tracer::Buffer *Tracer::freeBuffers = nullptr;
+
+void Tracer::setEnabled(bool isEnabled) {
+    enabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+long long Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+//buffers stay registered after their threads exit, so their events can still be dumped until a later thread overwrites them
+Tracer::ThreadState &Tracer::getThreadState() {
+    thread_local ThreadState state;
+    if (state.buffer == nullptr) {
+        state.threadIndex = threadNum.fetch_add(1, std::memory_order_relaxed) + 1;
+        {
+            std::lock_guard<std::mutex> lock(freeBufferMutex);
+            if (freeBuffers != nullptr) {
+                state.buffer = freeBuffers;
+                freeBuffers = freeBuffers->nextFree;
+            }
+        }
+        if (state.buffer == nullptr) {
+            state.buffer = new Buffer;
+            state.buffer->next = buffers.load(std::memory_order_relaxed);
+            while (!buffers.compare_exchange_weak(state.buffer->next, state.buffer, std::memory_order_release, std::memory_order_relaxed))
+                ;//try again
+        }
+    }
+    return state;
+}
+
+Tracer::ThreadState::~ThreadState() {
+    if (buffer == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(freeBufferMutex);
+    buffer->nextFree = freeBuffers;
+    freeBuffers = buffer;
+}
+
+void Tracer::record(const char *name, long long begin, long long end) {
+    ThreadState &state = getThreadState();
+    Buffer *buffer = state.buffer;
+    unsigned long long head = buffer->head.load(std::memory_order_relaxed);
+    Event &event = buffer->events[head & (bufferCapacity - 1)];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    event.threadIndex = state.threadIndex;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::dump(std::ostream &output) {
+    std::ios_base::fmtflags flags = output.flags();
+    std::streamsize precision = output.precision();
+    output << std::fixed << std::setprecision(3);
+    output << "{\"traceEvents\":[";
+    bool isFirst = true;
+    for (Buffer *buffer = buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+        unsigned long long head = buffer->head.load(std::memory_order_acquire);
+        //the oldest events are overwritten once the ring is full
+        unsigned long long tail = head > bufferCapacity ? head - bufferCapacity : 0;
+        for (unsigned long long i = tail; i < head; ++i) {
+            const Event &event = buffer->events[i & (bufferCapacity - 1)];
+            if (!isFirst)
+                output << ',';
+            isFirst = false;
+            output << "\n{\"name\":\"" << event.name
+                   << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadIndex
+                   << ",\"ts\":" << event.begin / 1000.0
+                   << ",\"dur\":" << (event.end - event.begin) / 1000.0 << '}';
+        }
+    }
+    output << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+    output.flags(flags);
+    output.precision(precision);
+}
+
+#endif // SOLVER_TRACING
@@ -0,0 +1,95 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+//scoped event tracing for the solver and the generator hot paths
+//compiled in only when SOLVER_TRACING is defined, otherwise TRACE_SCOPE expands to nothing
+//every thread records into its own ring buffer, the result is dumped as Chrome/Perfetto trace JSON
+//a thread hands its buffer back when it exits and a later thread records into it after the old events,
+//so there are only as many buffers as threads were ever running at once
+
+#ifdef SOLVER_TRACING
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+class Tracer {
+
+public:
+
+    static void setEnabled(bool);
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+    static long long now(); //nanoseconds since the tracer was loaded
+    static void record(const char *, long long, long long);
+    static void dump(std::ostream &); //call it after the traced threads are done
+
+    class Scope {
+
+    public:
+        explicit Scope(const char *name) : name(name), begin(isEnabled() ? now() : -1) {}
+        ~Scope() {
+            if (begin >= 0)
+                record(name, begin, now());
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *name; //must be a string literal
+        long long begin;
+    };
+
+private:
+
+    struct Event {
+        const char *name;
+        long long begin;
+        long long end;
+        unsigned threadIndex; //a buffer holds the events of every thread that used it
+    };
+
+    //power of two, so the ring index is a mask
+    static const unsigned long long bufferCapacity = 1 << 15;
+
+    //written by its owner thread only, read by dump
+    struct Buffer {
+        Event events[bufferCapacity];
+        std::atomic<unsigned long long> head;
+        Buffer *next;
+        Buffer *nextFree;
+
+        Buffer() : head(0), next(nullptr), nextFree(nullptr) {}
+    };
+
+    //the buffer of a thread, handed back by the destructor when the thread exits
+    struct ThreadState {
+        Buffer *buffer;
+        unsigned threadIndex;
+
+        ThreadState() : buffer(nullptr), threadIndex(0) {}
+        ~ThreadState();
+    };
+
+    static std::atomic<bool> enabled;
+    static std::atomic<Buffer *> buffers; //lock-free stack of all registered buffers
+    static std::atomic<unsigned> threadNum;
+    static std::mutex freeBufferMutex;
+    static Buffer *freeBuffers; //buffers of exited threads, guarded by freeBufferMutex
+
+    static ThreadState &getThreadState();
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) Tracer::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#else
+
+#define TRACE_SCOPE(name)
+
+#endif // SOLVER_TRACING
+
+#endif // TRACE_H
@@ -0,0 +1,342 @@
+#include "XorMatrix.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+//std::fill takes the constant by reference, so it needs a definition
+const unsigned XorMatrix::noPivot;
+
+XorMatrix::XorMatrix(const CNFFormula &formula, unsigned maxDetectedLength)
+    : variableNum(formula.getVariableNum()),
+      columnNum(0),
+      rowNum(0),
+      wordNum(0),
+      detectedXorNum(0),
+      columns(nullptr),
+      columnVariables(nullptr),
+      words(nullptr),
+      rightHandSides(nullptr),
+      pivots(nullptr),
+      pivotRows(nullptr),
+      conflictRowNum(0),
+      rowLevelStamps(nullptr),
+      levelStamp(0),
+      levelStampNum(0) {
+    TRACE_SCOPE("XorMatrix::XorMatrix");
+
+    //every XOR constraint is a list of literals whose exclusive or is true
+    std::vector<std::vector<int>> xors;
+    for (unsigned i = 0; i < formula.getXorNum(); ++i)
+        xors.emplace_back(formula.getXorLiterals(i), formula.getXorLiterals(i) + formula.getXorLength(i));
+    if (maxDetectedLength >= 3)
+        detectXors(formula, std::min(maxDetectedLength, 6u), xors);
+    detectedXorNum = static_cast<unsigned>(xors.size()) - formula.getXorNum();
+
+    //only the variables of XOR constraints get a column
+    columns = new unsigned[variableNum + 1];
+    std::fill(columns, columns + variableNum + 1, noPivot);
+    for (const std::vector<int> &xorLiterals : xors) {
+        for (int literal : xorLiterals) {
+            if (columns[std::abs(literal)] == noPivot)
+                columns[std::abs(literal)] = columnNum++;
+        }
+    }
+    columnVariables = new unsigned[columnNum];
+    for (unsigned i = 1; i <= variableNum; ++i) {
+        if (columns[i] != noPivot)
+            columnVariables[columns[i]] = i;
+    }
+
+    rowNum = static_cast<unsigned>(xors.size());
+    wordNum = (columnNum + 63) / 64;
+    words = new std::uint64_t[static_cast<std::size_t>(rowNum) * wordNum]();
+    rightHandSides = new unsigned char[rowNum];
+    pivots = new unsigned[rowNum];
+    pivotRows = new unsigned[columnNum];
+    std::fill(pivotRows, pivotRows + columnNum, noPivot);
+    rowLevelStamps = new unsigned long long[rowNum]();
+    for (unsigned i = 0; i < rowNum; ++i) {
+        //a negative literal flips the right-hand side, a repeated variable cancels itself
+        rightHandSides[i] = 1;
+        for (int literal : xors[i]) {
+            unsigned column = columns[std::abs(literal)];
+            words[i * wordNum + column / 64] ^= std::uint64_t(1) << (column % 64);
+            rightHandSides[i] ^= literal < 0;
+        }
+    }
+
+    //Gauss-Jordan elimination, the rows below the rank are empty
+    unsigned rank = 0;
+    for (unsigned column = 0; column < columnNum && rank < rowNum; ++column) {
+        unsigned row = rank;
+        while (row < rowNum && !isSet(row, column))
+            ++row;
+        if (row == rowNum)
+            continue;
+        swapRows(row, rank);
+        pivots[rank] = column;
+        pivotRows[column] = rank;
+        eliminate(rank, column);
+        ++rank;
+    }
+    for (unsigned i = rank; i < rowNum; ++i) {
+        pivots[i] = noPivot;
+        conflictRowNum += rightHandSides[i];
+    }
+}
+
+XorMatrix::XorMatrix(const XorMatrix &matrix)
+    : variableNum(matrix.variableNum),
+      columnNum(matrix.columnNum),
+      rowNum(matrix.rowNum),
+      wordNum(matrix.wordNum),
+      detectedXorNum(matrix.detectedXorNum),
+      columns(new unsigned[variableNum + 1]),
+      columnVariables(new unsigned[columnNum]),
+      words(new std::uint64_t[static_cast<std::size_t>(rowNum) * wordNum]),
+      rightHandSides(new unsigned char[rowNum]),
+      pivots(new unsigned[rowNum]),
+      pivotRows(new unsigned[columnNum]),
+      conflictRowNum(matrix.conflictRowNum),
+      rowLevelStamps(new unsigned long long[rowNum]),
+      levelStamp(matrix.levelStamp),
+      levelStampNum(matrix.levelStampNum),
+      savedRows(matrix.savedRows),
+      savedWords(matrix.savedWords),
+      savedLevels(matrix.savedLevels) {
+    std::copy(matrix.columns, matrix.columns + variableNum + 1, columns);
+    std::copy(matrix.columnVariables, matrix.columnVariables + columnNum, columnVariables);
+    std::copy(matrix.words, matrix.words + static_cast<std::size_t>(rowNum) * wordNum, words);
+    std::copy(matrix.rightHandSides, matrix.rightHandSides + rowNum, rightHandSides);
+    std::copy(matrix.pivots, matrix.pivots + rowNum, pivots);
+    std::copy(matrix.pivotRows, matrix.pivotRows + columnNum, pivotRows);
+    std::copy(matrix.rowLevelStamps, matrix.rowLevelStamps + rowNum, rowLevelStamps);
+}
+
+XorMatrix::~XorMatrix() {
+    delete[] columns;
+    delete[] columnVariables;
+    delete[] words;
+    delete[] rightHandSides;
+    delete[] pivots;
+    delete[] pivotRows;
+    delete[] rowLevelStamps;
+}
+
+void XorMatrix::assign(unsigned variable, bool value) {
+    unsigned column = columns[variable];
+    if (column == noPivot)
+        return;
+
+    //fold the column into the right-hand sides
+    std::uint64_t bit = std::uint64_t(1) << (column % 64);
+    std::uint64_t *word = words + column / 64;
+    for (unsigned i = 0; i < rowNum; ++i, word += wordNum) {
+        if (*word & bit) {
+            saveRow(i);
+            *word ^= bit;
+            rightHandSides[i] ^= value;
+        }
+    }
+
+    //the row that lost its pivot takes the next column and eliminates it from the other rows
+    unsigned row = pivotRows[column];
+    if (row == noPivot)
+        return;
+    pivotRows[column] = noPivot;
+    saveRow(row);
+    unsigned pivot = findPivot(row);
+    pivots[row] = pivot;
+    if (pivot == noPivot) {
+        conflictRowNum += rightHandSides[row];
+        return;
+    }
+    pivotRows[pivot] = row;
+    eliminate(row, pivot);
+}
+
+unsigned XorMatrix::propagate(List<int> &literals) {
+    unsigned impliedLiteralNum = 0;
+    for (unsigned i = 0; i < rowNum; ++i) {
+        if (pivots[i] == noPivot || !hasSinglePivot(i))
+            continue;
+        int literal = static_cast<int>(columnVariables[pivots[i]]);
+        if (!rightHandSides[i])
+            literal = -literal;
+        if (!literals.doesContain(literal)) {
+            literals.addBack(literal);
+            ++impliedLiteralNum;
+        }
+    }
+    return impliedLiteralNum;
+}
+
+//the columns without pivot are taken false, then every pivot equals its right-hand side
+unsigned XorMatrix::getModelLiterals(int *literals) const {
+    unsigned literalNum = 0;
+    for (unsigned i = 0; i < rowNum; ++i) {
+        if (pivots[i] != noPivot) {
+            int literal = static_cast<int>(columnVariables[pivots[i]]);
+            literals[literalNum++] = rightHandSides[i] ? literal : -literal;
+        }
+    }
+    return literalNum;
+}
+
+bool XorMatrix::hasVariable(unsigned variable) const {
+    return columns[variable] != noPivot;
+}
+
+void XorMatrix::pushLevel() {
+    savedLevels.push_back(SavedLevel{savedRows.size(), levelStamp, conflictRowNum});
+    levelStamp = ++levelStampNum;
+}
+
+//only the saved rows can have changed their pivots, so only their pivot columns are cleared and set again
+void XorMatrix::popLevel() {
+    const SavedLevel &level = savedLevels.back();
+    for (std::size_t i = level.savedRowNum; i < savedRows.size(); ++i) {
+        unsigned pivot = pivots[savedRows[i].row];
+        if (pivot != noPivot)
+            pivotRows[pivot] = noPivot;
+    }
+    for (std::size_t i = level.savedRowNum; i < savedRows.size(); ++i) {
+        const SavedRow &savedRow = savedRows[i];
+        std::copy(savedWords.begin() + i * wordNum, savedWords.begin() + (i + 1) * wordNum,
+                  words + static_cast<std::size_t>(savedRow.row) * wordNum);
+        rightHandSides[savedRow.row] = savedRow.rightHandSide;
+        pivots[savedRow.row] = savedRow.pivot;
+        if (savedRow.pivot != noPivot)
+            pivotRows[savedRow.pivot] = savedRow.row;
+        rowLevelStamps[savedRow.row] = savedRow.previousLevelStamp;
+    }
+    savedRows.resize(level.savedRowNum);
+    savedWords.resize(level.savedRowNum * wordNum);
+    conflictRowNum = level.conflictRowNum;
+    levelStamp = level.levelStamp;
+    savedLevels.pop_back();
+}
+
+//clause i forbids the assignment that makes all its literals false,
+//so the clauses with an even number of negative literals on k variables rule out the even assignments
+//and together say that the exclusive or of the variables is true, the odd ones say it is false
+void XorMatrix::detectXors(const CNFFormula &formula, unsigned maxLength, std::vector<std::vector<int>> &xors) {
+    //sign patterns seen for each sorted variable list, bit j is set when the negative literals form j
+    std::map<std::vector<int>, std::uint64_t> patterns;
+    std::vector<int> sortedLiterals;
+    std::vector<int> variables;
+    for (unsigned i = 0; i < formula.getClauseNum(); ++i) {
+        unsigned length = formula.getClauseLength(i);
+        if (length < 3 || length > maxLength)
+            continue;
+        sortedLiterals.assign(formula.getClauseLiterals(i), formula.getClauseLiterals(i) + length);
+        std::sort(sortedLiterals.begin(), sortedLiterals.end(), [](int a, int b) {
+            return std::abs(a) < std::abs(b);
+        });
+        variables.clear();
+        unsigned pattern = 0;
+        for (unsigned j = 0; j < length; ++j) {
+            variables.push_back(std::abs(sortedLiterals[j]));
+            if (sortedLiterals[j] < 0)
+                pattern |= 1u << j;
+        }
+        //a tautology like x or !x has a repeated variable and is no part of an XOR constraint
+        if (std::adjacent_find(variables.begin(), variables.end()) == variables.end())
+            patterns[variables] |= std::uint64_t(1) << pattern;
+    }
+
+    for (const auto &entry : patterns) {
+        unsigned length = static_cast<unsigned>(entry.first.size());
+        std::uint64_t evenPatterns = 0;
+        std::uint64_t oddPatterns = 0;
+        for (unsigned pattern = 0; pattern < (1u << length); ++pattern) {
+            unsigned negativeNum = 0;
+            for (unsigned j = 0; j < length; ++j)
+                negativeNum += (pattern >> j) & 1;
+            if (negativeNum % 2 == 0)
+                evenPatterns |= std::uint64_t(1) << pattern;
+            else
+                oddPatterns |= std::uint64_t(1) << pattern;
+        }
+        if ((entry.second & evenPatterns) == evenPatterns)
+            xors.push_back(entry.first);
+        if ((entry.second & oddPatterns) == oddPatterns) {
+            xors.push_back(entry.first);
+            xors.back().front() = -xors.back().front();
+        }
+    }
+}
+
+unsigned XorMatrix::getLowestBit(std::uint64_t word) {
+#ifdef __GNUC__
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+inline bool XorMatrix::isSet(unsigned row, unsigned column) const {
+    return (words[row * wordNum + column / 64] >> (column % 64)) & 1;
+}
+
+//target row ^= source row, word by word
+inline void XorMatrix::addRow(unsigned targetRow, unsigned sourceRow) {
+    std::uint64_t *target = words + static_cast<std::size_t>(targetRow) * wordNum;
+    const std::uint64_t *source = words + static_cast<std::size_t>(sourceRow) * wordNum;
+    for (unsigned i = 0; i < wordNum; ++i)
+        target[i] ^= source[i];
+    rightHandSides[targetRow] ^= rightHandSides[sourceRow];
+}
+
+void XorMatrix::swapRows(unsigned firstRow, unsigned secondRow) {
+    if (firstRow == secondRow)
+        return;
+    std::swap_ranges(words + static_cast<std::size_t>(firstRow) * wordNum,
+                     words + static_cast<std::size_t>(firstRow + 1) * wordNum,
+                     words + static_cast<std::size_t>(secondRow) * wordNum);
+    std::swap(rightHandSides[firstRow], rightHandSides[secondRow]);
+}
+
+//clear the pivot column in all the rows but the pivot row
+void XorMatrix::eliminate(unsigned pivotRow, unsigned column) {
+    for (unsigned i = 0; i < rowNum; ++i) {
+        if (i != pivotRow && isSet(i, column)) {
+            saveRow(i);
+            addRow(i, pivotRow);
+        }
+    }
+}
+
+unsigned XorMatrix::findPivot(unsigned row) const {
+    const std::uint64_t *rowWords = words + static_cast<std::size_t>(row) * wordNum;
+    for (unsigned i = 0; i < wordNum; ++i) {
+        if (rowWords[i] != 0)
+            return i * 64 + getLowestBit(rowWords[i]);
+    }
+    return noPivot;
+}
+
+void XorMatrix::appendSavedRow(unsigned row) {
+    savedRows.push_back(SavedRow{row, pivots[row], rightHandSides[row], rowLevelStamps[row]});
+    savedWords.insert(savedWords.end(), words + static_cast<std::size_t>(row) * wordNum,
+                      words + static_cast<std::size_t>(row + 1) * wordNum);
+    rowLevelStamps[row] = levelStamp;
+}
+
+//whether the pivot is the only column left in the row
+bool XorMatrix::hasSinglePivot(unsigned row) const {
+    const std::uint64_t *rowWords = words + static_cast<std::size_t>(row) * wordNum;
+    unsigned pivotWord = pivots[row] / 64;
+    std::uint64_t pivotBit = std::uint64_t(1) << (pivots[row] % 64);
+    for (unsigned i = 0; i < wordNum; ++i) {
+        if ((i == pivotWord ? rowWords[i] ^ pivotBit : rowWords[i]) != 0)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+#ifndef XORMATRIX_H
+#define XORMATRIX_H
+
+#include "CNFFormula.h"
+#include "List.h"
+#include <cstdint>
+#include <vector>
+
+//XOR constraints over the variables of a formula kept in reduced row echelon form
+//every row is a bit set of the unassigned variables packed into 64-bit words plus its right-hand side
+//assigning a variable folds its column into the right-hand sides, and the row that had it as pivot
+//gets a new pivot that is eliminated from all the other rows, so the matrix stays fully reduced
+//a row left with its pivot only is an implied literal, an empty row with right-hand side 1 is a conflict
+//a branching saves only the rows changed below it, each before its first change, and going back restores just those
+class XorMatrix {
+
+public:
+
+    //XOR constraints are taken from the x lines of the formula and detected from its clauses,
+    //a set of 2^(k-1) clauses on the same k variables ruling out one parity is one XOR constraint
+    //maxDetectedLength 0 takes the x lines only
+    explicit XorMatrix(const CNFFormula &, unsigned maxDetectedLength = 6);
+    XorMatrix(const XorMatrix &); //the reduced matrix of a shared CNFInstance, for one solver to work on
+    ~XorMatrix();
+    bool isEmpty() const; //no XOR constraint found
+    unsigned getRowNum() const;
+    unsigned getDetectedXorNum() const;
+    bool hasConflict() const;
+    bool hasVariable(unsigned) const;
+    void assign(unsigned, bool);
+    unsigned propagate(List<int> &); //add the implied literals not in the list, returns their number
+    unsigned getModelLiterals(int *) const; //values for the unassigned variables satisfying every row
+    void pushLevel(); //start saving the rows changed by a branching
+    void popLevel(); //go back to the matrix at the matching pushLevel
+
+    //disable all the unused functions
+    XorMatrix(XorMatrix &&) = delete;
+    XorMatrix &operator=(const XorMatrix &) = delete;
+    XorMatrix &operator=(XorMatrix &&) = delete;
+
+private:
+
+    static const unsigned noPivot = static_cast<unsigned>(-1);
+
+    unsigned variableNum;
+    unsigned columnNum;
+    unsigned rowNum;
+    unsigned wordNum; //words per row
+    unsigned detectedXorNum;
+
+    unsigned *columns; //column of each variable or noPivot, array size decided by variableNum + 1
+    unsigned *columnVariables; //array size decided by columnNum
+
+    std::uint64_t *words; //row i is words[i * wordNum] to words[(i + 1) * wordNum - 1]
+    unsigned char *rightHandSides; //array size decided by rowNum
+    unsigned *pivots; //pivot column of each row or noPivot, array size decided by rowNum
+    unsigned *pivotRows; //row of each pivot column or noPivot, array size decided by columnNum
+    unsigned conflictRowNum;
+
+    struct SavedRow {
+        unsigned row;
+        unsigned pivot;
+        unsigned char rightHandSide;
+        unsigned long long previousLevelStamp;
+    };
+
+    struct SavedLevel {
+        std::size_t savedRowNum; //rows saved before the level
+        unsigned long long levelStamp; //stamp of the level below
+        unsigned conflictRowNum;
+    };
+
+    //every pushLevel gets a new stamp, a row carrying the current one is already saved at this level
+    //the stamp is 0 below every pushLevel, where nothing is saved
+    unsigned long long *rowLevelStamps; //array size decided by rowNum
+    unsigned long long levelStamp;
+    unsigned long long levelStampNum;
+    std::vector<SavedRow> savedRows; //of all the levels, one after another
+    std::vector<std::uint64_t> savedWords; //words of the saved rows, wordNum for each
+    std::vector<SavedLevel> savedLevels;
+
+    static void detectXors(const CNFFormula &, unsigned, std::vector<std::vector<int>> &);
+    static unsigned getLowestBit(std::uint64_t);
+    bool isSet(unsigned, unsigned) const;
+    void addRow(unsigned, unsigned);
+    void swapRows(unsigned, unsigned);
+    void eliminate(unsigned, unsigned);
+    unsigned findPivot(unsigned) const;
+    bool hasSinglePivot(unsigned) const;
+    void saveRow(unsigned); //call it before changing the row
+    void appendSavedRow(unsigned);
+};
+
+inline bool XorMatrix::isEmpty() const {
+    return rowNum == 0;
+}
+
+inline unsigned XorMatrix::getRowNum() const {
+    return rowNum;
+}
+
+inline unsigned XorMatrix::getDetectedXorNum() const {
+    return detectedXorNum;
+}
+
+inline bool XorMatrix::hasConflict() const {
+    return conflictRowNum != 0;
+}
+
+inline void XorMatrix::saveRow(unsigned row) {
+    if (rowLevelStamps[row] != levelStamp)
+        appendSavedRow(row);
+}
+
+#endif // XORMATRIX_H
@@ -0,0 +1,143 @@
+#include "CNFSolver.h"
+#include "List.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <thread>
+
+//usage: ListAllocatorBenchmark [CNF files...]
+//prints allocation counts and times of List operations with both allocator policies,
+//then solves the given files with the allocator this binary was built with
+
+namespace {
+    std::atomic<unsigned long long> allocationNum(0);
+}
+
+void *operator new(std::size_t size) {
+    allocationNum.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+template <typename Allocator>
+void benchmarkList(const char *name) {
+    using namespace std::chrono;
+    const unsigned rounds = 200;
+    const unsigned length = 10000;
+    List<unsigned, Allocator> stack;
+    List<int, Allocator> queue;
+
+    unsigned long long allocationBegin = allocationNum.load();
+    auto begin = steady_clock::now();
+    for (unsigned round = 0; round < rounds; ++round) {
+        //the satisfiedOccur/deletedOccur pattern
+        for (unsigned i = 0; i < length; ++i)
+            stack.addFront(i);
+        while (!stack.isEmpty())
+            stack.removeFront();
+        //the unitClauseLiteralsToAssign pattern
+        for (unsigned i = 0; i < length; ++i) {
+            queue.addBack(static_cast<int>(i));
+            if (i % 3 == 0)
+                queue.removeFront();
+        }
+        queue.clear();
+    }
+    auto end = steady_clock::now();
+    unsigned long long operationNum = 2ULL * rounds * length + 4ULL * rounds * length / 3;
+    std::cout << name << ": " << allocationNum.load() - allocationBegin << " allocations, "
+              << duration_cast<duration<double, std::nano>>(end - begin).count() / operationNum << " ns/op" << std::endl;
+}
+
+//lists built on one thread and cleared on another, as when jobs hand their lists over,
+//with the pool the later rounds allocate next to nothing, because the freed nodes come back through the depot
+template <typename Allocator>
+void benchmarkCrossThreadFrees(const char *name) {
+    const unsigned rounds = 50;
+    const unsigned length = 100000;
+    std::mutex mutex;
+    std::condition_variable condition;
+    List<unsigned, Allocator> handedList;
+    bool isHanded = false;
+    unsigned long long firstRoundAllocationNum = 0;
+
+    unsigned long long allocationBegin = allocationNum.load();
+    std::thread consumer([&] {
+        for (unsigned round = 0; round < rounds; ++round) {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&] { return isHanded; });
+            List<unsigned, Allocator> list(std::move(handedList));
+            isHanded = false;
+            lock.unlock();
+            condition.notify_one();
+            list.clear();
+        }
+    });
+    for (unsigned round = 0; round < rounds; ++round) {
+        List<unsigned, Allocator> list;
+        for (unsigned i = 0; i < length; ++i)
+            list.addBack(i);
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&] { return !isHanded; });
+        handedList = std::move(list);
+        isHanded = true;
+        lock.unlock();
+        condition.notify_one();
+        if (round == 0)
+            firstRoundAllocationNum = allocationNum.load() - allocationBegin;
+    }
+    consumer.join();
+    std::cout << name << ": " << firstRoundAllocationNum << " allocations in the first round, "
+              << allocationNum.load() - allocationBegin - firstRoundAllocationNum << " in the other " << rounds - 1 << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    using namespace std::chrono;
+
+    std::cout << "List<T> microbenchmark" << std::endl;
+    //warm up the pool so only steady state is measured
+    benchmarkList<PooledNodeAllocator>("pooled (warm-up)");
+    benchmarkList<NewDeleteNodeAllocator>("new/delete");
+    benchmarkList<PooledNodeAllocator>("pooled");
+    benchmarkCrossThreadFrees<NewDeleteNodeAllocator>("new/delete across threads");
+    benchmarkCrossThreadFrees<PooledNodeAllocator>("pooled across threads");
+
+#ifdef LIST_NEW_DELETE_NODES
+    std::cout << std::endl << "CNFSolver with new/delete nodes" << std::endl;
+#else
+    std::cout << std::endl << "CNFSolver with pooled nodes" << std::endl;
+#endif
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream input(argv[i]);
+        if (!input) {
+            std::cout << argv[i] << ": cannot open" << std::endl;
+            continue;
+        }
+        unsigned long long allocationBegin = allocationNum.load();
+        auto begin = steady_clock::now();
+        bool result;
+        {
+            CNFSolver solver(input, CNFSolver::DLCS);
+            result = solver.isSatisfied();
+        }
+        auto end = steady_clock::now();
+        std::cout << argv[i] << ": s " << result << ", "
+                  << allocationNum.load() - allocationBegin << " allocations, "
+                  << duration_cast<duration<double, std::milli>>(end - begin).count() << " ms" << std::endl;
+    }
+    return 0;
+}
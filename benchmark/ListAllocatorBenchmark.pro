@@ -0,0 +1,41 @@
+#-------------------------------------------------
+#
+# Compares the pooled List node allocator with plain new/delete.
+# Build it once as is and once with "qmake CONFIG+=list_new_delete"
+# to compare the solver before and after the pool.
+#
+#-------------------------------------------------
+
+TARGET = ListAllocatorBenchmark
+TEMPLATE = app
+
+CONFIG += console c++11 thread
+CONFIG -= app_bundle qt
+
+list_new_delete: DEFINES += LIST_NEW_DELETE_NODES
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        ListAllocatorBenchmark.cpp \
+        ../CNFFeatures.cpp \
+        ../CNFInstance.cpp \
+        ../CNFFormula.cpp \
+        ../CNFSolver.cpp \
+        ../CheckpointWriter.cpp \
+        ../DratWriter.cpp \
+        ../SudokuCache.cpp \
+        ../Trace.cpp \
+        ../XorMatrix.cpp
+
+HEADERS += \
+        ../CNFFeatures.h \
+        ../CNFInstance.h \
+        ../CNFFormula.h \
+        ../CNFSolver.h \
+        ../CheckpointWriter.h \
+        ../List.h \
+        ../NodeAllocator.h \
+        ../SudokuCache.h \
+        ../TextFormatter.h \
+        ../XorMatrix.h
@@ -0,0 +1,323 @@
+#include "CNFFormula.h"
+#include "CNFSolver.h"
+#include "List.h"
+#include "SudokuCache.h"
+#include "SudokuGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//usage: MicroBenchmark [repetitions]
+//times the hot primitives on inputs made from fixed seeds, so the numbers of two commits can be compared
+//every benchmark is run once to warm up, then the median and the minimum of the repetitions are printed,
+//the minimum being the least disturbed by the rest of the machine
+
+namespace {
+
+    const unsigned defaultRepetitionNum = 9;
+    const unsigned formulaSeed = 2019;
+    const unsigned sudokuSeeds[] = {1, 2, 3};
+
+    //results are added here so that the compiler keeps the work
+    volatile long long sink = 0;
+
+    //run returns the nanoseconds of its timed part, which does operationNum operations
+    template <typename Function>
+    void report(const std::string &name, unsigned repetitionNum, double operationNum, const char *unit, Function run) {
+        run();
+        std::vector<double> times;
+        for (unsigned i = 0; i < repetitionNum; ++i)
+            times.push_back(run() / operationNum);
+        std::sort(times.begin(), times.end());
+        std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << times[times.size() / 2] << std::setw(14) << times.front() << " " << unit << std::endl;
+    }
+
+    template <typename Function>
+    double measure(Function function) {
+        using namespace std::chrono;
+        auto begin = steady_clock::now();
+        function();
+        return duration_cast<duration<double, std::nano>>(steady_clock::now() - begin).count();
+    }
+
+    //random clauses of minLength to maxLength distinct variables in DIMACS
+    std::string makeRandomFormula(unsigned variableNum, unsigned clauseNum, unsigned minLength, unsigned maxLength) {
+        std::mt19937 randomGenerator(formulaSeed);
+        std::ostringstream output;
+        output << "p cnf " << variableNum << " " << clauseNum << "\n";
+        std::vector<int> clause;
+        for (unsigned i = 0; i < clauseNum; ++i) {
+            unsigned length = minLength + randomGenerator() % (maxLength - minLength + 1);
+            clause.clear();
+            while (clause.size() < length) {
+                int variable = static_cast<int>(randomGenerator() % variableNum) + 1;
+                if (std::find(clause.begin(), clause.end(), variable) == clause.end()
+                        && std::find(clause.begin(), clause.end(), -variable) == clause.end())
+                    clause.push_back(randomGenerator() & 1 ? variable : -variable);
+            }
+            for (int literal : clause)
+                output << literal << " ";
+            output << "0\n";
+        }
+        return output.str();
+    }
+
+    //clauses of 3 variables within a window of a ring, like the neighbourhoods of an encoded circuit or grid,
+    //the variables are then numbered in a random order, as DIMACS files often are
+    std::string makeShuffledLocalFormula(unsigned variableNum, unsigned clauseNum, unsigned window) {
+        std::mt19937 randomGenerator(formulaSeed);
+        std::vector<int> numbers(variableNum);
+        for (unsigned i = 0; i < variableNum; ++i)
+            numbers[i] = static_cast<int>(i) + 1;
+        std::shuffle(numbers.begin(), numbers.end(), randomGenerator);
+        std::ostringstream output;
+        output << "p cnf " << variableNum << " " << clauseNum << "\n";
+        std::vector<int> clause;
+        for (unsigned i = 0; i < clauseNum; ++i) {
+            unsigned center = randomGenerator() % variableNum;
+            clause.clear();
+            while (clause.size() < 3) {
+                int variable = numbers[(center + randomGenerator() % window) % variableNum];
+                if (std::find(clause.begin(), clause.end(), variable) == clause.end()
+                        && std::find(clause.begin(), clause.end(), -variable) == clause.end())
+                    clause.push_back(randomGenerator() & 1 ? variable : -variable);
+            }
+            for (int literal : clause)
+                output << literal << " ";
+            output << "0\n";
+        }
+        return output.str();
+    }
+
+    void benchmarkList(unsigned repetitionNum) {
+        const unsigned length = 100000;
+        List<unsigned> stack;
+        List<int> queue;
+        report("List addFront/removeFront", repetitionNum, 2.0 * length, "ns/op", [&] {
+            return measure([&] {
+                for (unsigned i = 0; i < length; ++i)
+                    stack.addFront(i);
+                while (!stack.isEmpty()) {
+                    sink = sink + stack.front();
+                    stack.removeFront();
+                }
+            });
+        });
+        report("List addBack/removeFront", repetitionNum, 2.0 * length, "ns/op", [&] {
+            return measure([&] {
+                for (unsigned i = 0; i < length; ++i)
+                    queue.addBack(static_cast<int>(i));
+                while (!queue.isEmpty()) {
+                    sink = sink + queue.front();
+                    queue.removeFront();
+                }
+            });
+        });
+    }
+
+}
+
+//the private kernels of the solver are reached through this friend
+class CNFSolverBenchmark {
+
+public:
+
+    //does what the search does before the first decision, false when that already decides the formula
+    static bool prepare(CNFSolver &solver) {
+        if (solver.preprocess() != CNFSolver::Continued)
+            return false;
+        if (solver.originalMaxClauseLength <= 2)
+            solver.twoLiteralClauses = solver.packClauses<2>();
+        else if (solver.originalMaxClauseLength == 3)
+            solver.threeLiteralClauses = solver.packClauses<3>();
+        return true;
+    }
+
+    //both polarities of every free variable are applied and undone, the number of assignments is returned
+    static unsigned runAssignments(CNFSolver &solver) {
+        if (solver.twoLiteralClauses != nullptr)
+            return runAssignments<2>(solver);
+        if (solver.threeLiteralClauses != nullptr)
+            return runAssignments<3>(solver);
+        return runAssignments<0>(solver);
+    }
+
+    static int runBranching(CNFSolver &solver, CNFSolver::BranchingRule rule) {
+        if (solver.twoLiteralClauses != nullptr)
+            return runBranching<2>(solver, rule);
+        if (solver.threeLiteralClauses != nullptr)
+            return runBranching<3>(solver, rule);
+        return runBranching<0>(solver, rule);
+    }
+
+private:
+
+    template <unsigned Width>
+    static unsigned runAssignments(CNFSolver &solver) {
+        unsigned assignmentNum = 0;
+        for (int variable = 1; variable <= static_cast<int>(solver.variableNum); ++variable) {
+            if (solver.variablesInfo[variable].assignedStatus != CNFSolver::VariableInfo::None)
+                continue;
+            for (int literal : {variable, -variable}) {
+                solver.applyAssignment<Width>(literal);
+                solver.undoAssignment<Width>(literal);
+                solver.unitClauseLiteralsToAssign.clear();
+                solver.hasEmptyClause = false;
+                ++assignmentNum;
+            }
+        }
+        return assignmentNum;
+    }
+
+    template <unsigned Width>
+    static int runBranching(CNFSolver &solver, CNFSolver::BranchingRule rule) {
+        switch (rule) {
+        case CNFSolver::DLCS:
+            return solver.getDLCSBranchingLiteral<Width>();
+        case CNFSolver::MOMS:
+            return solver.getMOMSBranchingLiteral<Width>();
+        default:
+            return solver.getLookaheadBranchingLiteral<Width>();
+        }
+    }
+};
+
+namespace {
+
+    void benchmarkSolver(const std::string &formulaName, const std::string &dimacs, unsigned repetitionNum) {
+        std::istringstream input(dimacs);
+        CNFFormula formula(input);
+
+        CNFSolver solver(formula, CNFSolver::DLCS);
+        if (!CNFSolverBenchmark::prepare(solver)) {
+            std::cout << formulaName << ": decided by preprocessing" << std::endl;
+            return;
+        }
+        double assignmentNum = CNFSolverBenchmark::runAssignments(solver);
+        report(formulaName + " apply/undoAssignment", repetitionNum, assignmentNum, "ns/op", [&] {
+            return measure([&] { CNFSolverBenchmark::runAssignments(solver); });
+        });
+
+        const unsigned branchingNum = 100;
+        report(formulaName + " DLCS branching", repetitionNum, branchingNum, "ns/op", [&] {
+            return measure([&] {
+                for (unsigned i = 0; i < branchingNum; ++i)
+                    sink = sink + CNFSolverBenchmark::runBranching(solver, CNFSolver::DLCS);
+            });
+        });
+        report(formulaName + " MOMS branching", repetitionNum, branchingNum, "ns/op", [&] {
+            return measure([&] {
+                for (unsigned i = 0; i < branchingNum; ++i)
+                    sink = sink + CNFSolverBenchmark::runBranching(solver, CNFSolver::MOMS);
+            });
+        });
+        //a lookahead may assign failed literals, so every run starts from a fresh solver
+        report(formulaName + " lookahead branching", repetitionNum, 1, "ns/op", [&] {
+            CNFSolver lookaheadSolver(formula, CNFSolver::Lookahead);
+            CNFSolverBenchmark::prepare(lookaheadSolver);
+            return measure([&] { sink = sink + CNFSolverBenchmark::runBranching(lookaheadSolver, CNFSolver::Lookahead); });
+        });
+    }
+
+    //the same formula in the numbering of the file and after CNFFormula::renumber
+    void benchmarkRenumbering(const std::string &formulaName, const std::string &dimacs, unsigned repetitionNum) {
+        for (bool renumbers : {false, true}) {
+            std::istringstream input(dimacs);
+            CNFFormula formula(input);
+            std::string name = formulaName + (renumbers ? " renumbered" : " shuffled");
+            if (renumbers) {
+                report(name + " renumber", repetitionNum, 1, "ms/op", [&] {
+                    CNFFormula copy(formula);
+                    return measure([&] { copy.renumber(); }) / 1000000;
+                });
+                formula.renumber();
+            }
+            std::cout << name << ": average clause span " << formula.getClauseSpan() << std::endl;
+
+            CNFSolver solver(formula, CNFSolver::DLCS);
+            if (!CNFSolverBenchmark::prepare(solver)) {
+                std::cout << name << ": decided by preprocessing" << std::endl;
+                return;
+            }
+            double assignmentNum = CNFSolverBenchmark::runAssignments(solver);
+            report(name + " apply/undoAssignment", repetitionNum, assignmentNum, "ns/op", [&] {
+                return measure([&] { CNFSolverBenchmark::runAssignments(solver); });
+            });
+            report(name + " DLCS branching", repetitionNum, 1, "ms/op", [&] {
+                return measure([&] { sink = sink + CNFSolverBenchmark::runBranching(solver, CNFSolver::DLCS); }) / 1000000;
+            });
+        }
+    }
+
+    //the cache is cleared before every run, so no run profits from an earlier one
+    void benchmarkSudoku(unsigned repetitionNum) {
+        SudokuCache &cache = SudokuCache::getInstance();
+        unsigned puzzleNum = sizeof(sudokuSeeds) / sizeof(sudokuSeeds[0]);
+
+        //digging every remaining given of a puzzle with 30 givens
+        report("isUnique on 30 givens", repetitionNum, 30.0 * puzzleNum, "us/op", [&] {
+            double time = 0;
+            for (unsigned seed : sudokuSeeds) {
+                SudokuGenerator generator(seed);
+                generator.generate(30);
+                unsigned sudoku[10][10];
+                generator.getSudoku(sudoku);
+                cache.clear();
+                time += measure([&] {
+                    for (unsigned i = 1; i <= 9; ++i) {
+                        for (unsigned j = 1; j <= 9; ++j) {
+                            if (sudoku[i][j] != 0)
+                                sink = sink + generator.isUnique(i, j);
+                        }
+                    }
+                });
+            }
+            return time / 1000;
+        });
+
+        for (unsigned givenCellNum : {20u, 30u, 45u}) {
+            report("generate with " + std::to_string(givenCellNum) + " givens", repetitionNum, puzzleNum, "ms/op", [&] {
+                cache.clear();
+                return measure([&] {
+                    for (unsigned seed : sudokuSeeds) {
+                        SudokuGenerator generator(seed);
+                        sink = sink + generator.generate(givenCellNum);
+                    }
+                }) / 1000000;
+            });
+        }
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    unsigned repetitionNum = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : defaultRepetitionNum;
+    if (repetitionNum == 0)
+        repetitionNum = defaultRepetitionNum;
+
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right
+              << std::setw(14) << "median" << std::setw(14) << "minimum" << std::endl;
+    benchmarkList(repetitionNum);
+    benchmarkSolver("3-SAT 300x1278", makeRandomFormula(300, 1278, 3, 3), repetitionNum);
+    benchmarkSolver("mixed 200x1500", makeRandomFormula(200, 1500, 3, 6), repetitionNum);
+    benchmarkSolver("2/3-SAT 500x1500", makeRandomFormula(500, 1500, 2, 3), repetitionNum);
+    benchmarkRenumbering("local 200000x800000", makeShuffledLocalFormula(200000, 800000, 12), repetitionNum);
+    unsigned emptySudoku[10][10] = {{0}};
+    CNFSolver sudokuSolver(emptySudoku);
+    if (CNFSolverBenchmark::prepare(sudokuSolver)) {
+        double assignmentNum = CNFSolverBenchmark::runAssignments(sudokuSolver);
+        report("Sudoku apply/undoAssignment", repetitionNum, assignmentNum, "ns/op", [&] {
+            return measure([&] { CNFSolverBenchmark::runAssignments(sudokuSolver); });
+        });
+    }
+    benchmarkSudoku(repetitionNum);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#-------------------------------------------------
+#
+# Microbenchmarks of the List operations, the solver kernels,
+# the branching rules and the Sudoku generator on fixed seeds.
+# Run it from a release build, "MicroBenchmark 15" repeats every benchmark 15 times.
+#
+#-------------------------------------------------
+
+TARGET = MicroBenchmark
+TEMPLATE = app
+
+CONFIG += console c++11 release
+CONFIG -= app_bundle qt
+
+INCLUDEPATH += ..
+
+SOURCES += \
+        MicroBenchmark.cpp \
+        ../CNFFeatures.cpp \
+        ../CNFInstance.cpp \
+        ../CNFFormula.cpp \
+        ../CNFSolver.cpp \
+        ../CheckpointWriter.cpp \
+        ../DratWriter.cpp \
+        ../SudokuCache.cpp \
+        ../SudokuGenerator.cpp \
+        ../Trace.cpp \
+        ../XorMatrix.cpp
+
+HEADERS += \
+        ../CNFFeatures.h \
+        ../CNFInstance.h \
+        ../CNFFormula.h \
+        ../CNFSolver.h \
+        ../CheckpointWriter.h \
+        ../List.h \
+        ../NodeAllocator.h \
+        ../SudokuCache.h \
+        ../SudokuGenerator.h \
+        ../TextFormatter.h \
+        ../XorMatrix.h
@@ -2,13 +2,29 @@
 #include <QApplication>
 
 #include "CNFSolver.h"
+#include "Trace.h"
 #include <iostream>
 #include <fstream>
+#include <cstdlib>
 
 int main(int argc, char *argv[]) {
+#ifdef SOLVER_TRACING
+    //record a trace only when an output file is given
+    const char *traceFileName = std::getenv("SOLVER_TRACE");
+    Tracer::setEnabled(traceFileName != nullptr);
+#endif
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
 
-    return a.exec();
+    int result = a.exec();
+
+#ifdef SOLVER_TRACING
+    if (traceFileName != nullptr) {
+        std::ofstream traceFile(traceFileName);
+        Tracer::dump(traceFile);
+    }
+#endif
+    return result;
 }